@@ -0,0 +1,48 @@
+#ifndef __BENCHMARKS_CORPUS_HPP__
+#define __BENCHMARKS_CORPUS_HPP__
+
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "utils.hpp"
+
+namespace benchmarks {
+/**
+ * Gets the path of the corpus, it is taken from ANALYZE_STATISTICS_CORPUS environment variable, the sample test file is used by default.
+ * @returns `std::string`
+ */
+inline std::string corpus_path() {
+	const char* env = std::getenv("ANALYZE_STATISTICS_CORPUS");
+	return env != nullptr ? env : "./test/test_files/file.txt";
+}
+/**
+ * Gets the corpus text
+ * @returns `const std::string&`
+ */
+inline const std::string& corpus_text() {
+	static const std::string text = [](){
+		std::ifstream is(corpus_path());
+		return std::string((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+	}();
+	return text;
+}
+/**
+ * Gets the words of the corpus
+ * @returns `const std::vector<std::string>&`
+ */
+inline const std::vector<std::string>& corpus_words() {
+	static const std::vector<std::string> words = [](){
+		std::vector<std::string> ret{};
+		libs::utils::for_each_word(corpus_text(), [&ret](std::string_view word) {
+				ret.emplace_back(word);
+				});
+		return ret;
+	}();
+	return words;
+}
+}
+
+#endif // __BENCHMARKS_CORPUS_HPP__
@@ -0,0 +1,63 @@
+#include <benchmark/benchmark.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "corpus.hpp"
+#include "flat_counter.hpp"
+
+namespace {
+std::vector<std::string> synthetic_words(size_t distinct) {
+	std::vector<std::string> ret{};
+	ret.reserve(distinct);
+	for(size_t i = 0; i < distinct; ++i) {
+		ret.push_back("token" + std::to_string(i * 2654435761u % (distinct * 7)));
+	}
+	return ret;
+}
+
+void count_unordered_map(benchmark::State& state, const std::vector<std::string>& words) {
+	for(auto _: state) {
+		std::unordered_map<std::string, size_t> counter{};
+		for(const auto& word: words) {
+			++counter[word];
+		}
+		benchmark::DoNotOptimize(counter.size());
+	}
+	state.SetItemsProcessed(state.iterations() * words.size());
+}
+
+void count_flat_counter(benchmark::State& state, const std::vector<std::string>& words) {
+	size_t bytes = 0;
+	for(auto _: state) {
+		libs::datastructure::flat_counter<std::string, size_t> counter{};
+		for(const auto& word: words) {
+			counter.add(word, 1);
+		}
+		benchmark::DoNotOptimize(counter.size());
+		bytes = counter.memory_usage();
+	}
+	state.SetItemsProcessed(state.iterations() * words.size());
+	state.counters["table_bytes"] = bytes;
+}
+}
+
+static void BM_corpus_unordered_map(benchmark::State& state) {
+	count_unordered_map(state, benchmarks::corpus_words());
+}
+BENCHMARK(BM_corpus_unordered_map);
+
+static void BM_corpus_flat_counter(benchmark::State& state) {
+	count_flat_counter(state, benchmarks::corpus_words());
+}
+BENCHMARK(BM_corpus_flat_counter);
+
+static void BM_vocabulary_unordered_map(benchmark::State& state) {
+	count_unordered_map(state, synthetic_words(state.range(0)));
+}
+BENCHMARK(BM_vocabulary_unordered_map)->RangeMultiplier(16)->Range(1 << 10, 1 << 20)->Unit(benchmark::kMillisecond);
+
+static void BM_vocabulary_flat_counter(benchmark::State& state) {
+	count_flat_counter(state, synthetic_words(state.range(0)));
+}
+BENCHMARK(BM_vocabulary_flat_counter)->RangeMultiplier(16)->Range(1 << 10, 1 << 20)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,55 @@
+#include <boost/program_options.hpp>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "../zipf_corpus.hpp"
+
+namespace po = boost::program_options;
+
+void usage(char** argv, const po::options_description& desc) {
+	std::cout << "Usage: " << argv[0] << " -s [MiB] -o [output_file_path] --vocabulary [words] --exponent [s] --smileys [per 1000 words] --seed [seed]\n" <<
+		"Generates a reproducible corpus whose word frequencies follow Zipf's law, - or no output path writes the standard output\n" <<
+		desc;
+}
+
+int main(int argc, char** argv) {
+	std::ios_base::sync_with_stdio(false);
+	po::variables_map vm;
+	po::options_description arg_desc("Options");
+	arg_desc.add_options()
+		("help,h", "Print this help message")
+		("size,s", po::value<size_t>()->default_value(64), "The size of the corpus in MiB.")
+		("output_file_path,o", po::value<std::string>()->default_value("-"), "The output file path.")
+		("vocabulary", po::value<size_t>()->default_value(benchmarks::zipf_corpus_generator::default_vocabulary_size), "The number of the distinct words.")
+		("exponent", po::value<double>()->default_value(benchmarks::zipf_corpus_generator::default_exponent), "The exponent of Zipf's law, the higher the more skewed.")
+		("smileys", po::value<double>()->default_value(benchmarks::zipf_corpus_generator::default_smiley_density), "The average number of the smileys per 1000 words.")
+		("seed", po::value<uint64_t>()->default_value(benchmarks::zipf_corpus_generator::default_seed), "The seed of the random numbers.");
+	try {
+		po::store(po::parse_command_line(argc, argv, arg_desc), vm);
+		po::notify(vm);
+	} catch(std::exception& ex) {
+		std::cout << "Invalid usage: " << ex.what() << "\n";
+		usage(argv, arg_desc);
+		return 1;
+	}
+	if(vm.count("help")) {
+		usage(argv, arg_desc);
+		return 1;
+	}
+	benchmarks::zipf_corpus_generator generator(vm["vocabulary"].as<size_t>(), vm["exponent"].as<double>(),
+			vm["smileys"].as<double>(), vm["seed"].as<uint64_t>());
+	const size_t size = vm["size"].as<size_t>() * 1024 * 1024;
+	const std::string path = vm["output_file_path"].as<std::string>();
+	if(path == "-") {
+		generator.write(std::cout, size);
+		return std::cout.good() ? 0 : 1;
+	}
+	std::ofstream os(path, std::ios::binary);
+	if(!os.is_open()) {
+		std::cerr << "Error: Can't open the output file: " << path << "\n";
+		return 1;
+	}
+	generator.write(os, size);
+	return os.good() ? 0 : 1;
+}
@@ -0,0 +1,97 @@
+#include <benchmark/benchmark.h>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "flat_counter.hpp"
+#include "io_engine.hpp"
+#include "utils.hpp"
+#include "zipf_corpus.hpp"
+
+namespace {
+/*
+ * The generated corpora are kept in the temporary directory for the whole run, one per size in MiB
+ */
+const std::string& zipf_corpus_path(size_t mib) {
+	static std::map<size_t, std::string> paths{};
+	auto it = paths.find(mib);
+	if(it == paths.end()) {
+		const std::filesystem::path path = std::filesystem::temp_directory_path() /
+			("analyze_statistics_zipf_" + std::to_string(mib) + "MiB.txt");
+		if(!std::filesystem::exists(path) || std::filesystem::file_size(path) != mib * 1024 * 1024) {
+			std::ofstream os(path, std::ios::binary);
+			benchmarks::zipf_corpus_generator().write(os, mib * 1024 * 1024);
+		}
+		it = paths.emplace(mib, path.string()).first;
+	}
+	return it->second;
+}
+
+/*
+ * The whole pipeline over a Zipf corpus of `range(0)` MiB, the statistics are kept in memory or written to the database
+ */
+void run_zipf_engine(benchmark::State& state, bool database) {
+	const std::string& path = zipf_corpus_path(state.range(0));
+	const std::string db_path = (std::filesystem::temp_directory_path() / "analyze_statistics_benchmark.db").string();
+	size_t bytes = 0;
+	for(auto _: state) {
+		state.PauseTiming();
+		std::filesystem::remove(db_path);
+		state.ResumeTiming();
+		libs::proccesing::io_engine<std::string, size_t> engine(path, 64 * 1024, database ? db_path : "");
+		engine.read();
+		bytes += state.range(0) * 1024 * 1024;
+	}
+	state.SetBytesProcessed(bytes);
+	std::filesystem::remove(db_path);
+}
+}
+
+static void BM_zipf_engine_memory(benchmark::State& state) {
+	run_zipf_engine(state, false);
+}
+BENCHMARK(BM_zipf_engine_memory)->Arg(16)->Arg(64)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+static void BM_zipf_engine_db(benchmark::State& state) {
+	run_zipf_engine(state, true);
+}
+BENCHMARK(BM_zipf_engine_db)->Arg(16)->Arg(64)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+/*
+ * The smiley scan over 4 MiB with `range(0)` smileys per 1000 words
+ */
+static void BM_zipf_search_smileys(benchmark::State& state) {
+	const std::string text = benchmarks::zipf_corpus_generator(benchmarks::zipf_corpus_generator::default_vocabulary_size,
+			benchmarks::zipf_corpus_generator::default_exponent, state.range(0)).generate(4 * 1024 * 1024);
+	for(auto _: state) {
+		std::unordered_map<std::string, std::vector<size_t>> smileys{};
+		libs::utils::search_smileys<std::string, size_t>(text, text.size(), smileys);
+		benchmark::DoNotOptimize(smileys.size());
+	}
+	state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_zipf_search_smileys)->Arg(0)->Arg(1)->Arg(10)->Arg(100);
+
+/*
+ * The counting of 4 MiB of words whose distribution has the exponent of `range(0) / 10`, the higher the more skewed
+ */
+static void BM_zipf_flat_counter(benchmark::State& state) {
+	const std::string text = benchmarks::zipf_corpus_generator(benchmarks::zipf_corpus_generator::default_vocabulary_size,
+			state.range(0) / 10.0, 0).generate(4 * 1024 * 1024);
+	std::vector<std::string> words{};
+	libs::utils::for_each_word(text, [&words](std::string_view word) {
+			words.emplace_back(word);
+			});
+	for(auto _: state) {
+		libs::datastructure::flat_counter<std::string, size_t> counter{};
+		for(const auto& word: words) {
+			counter.add(word, 1);
+		}
+		benchmark::DoNotOptimize(counter.size());
+	}
+	state.SetItemsProcessed(state.iterations() * words.size());
+}
+BENCHMARK(BM_zipf_flat_counter)->Arg(8)->Arg(10)->Arg(12);
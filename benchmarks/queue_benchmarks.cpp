@@ -0,0 +1,119 @@
+#include <benchmark/benchmark.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ring_buffer.hpp"
+#include "task_queue.hpp"
+#include "work_stealing_queue.hpp"
+
+/*
+ * Pushes the tasks from a producer thread per range argument and drains them by the same number of consumers.
+ */
+template <typename Queue>
+static void run_producers_consumers(benchmark::State& state, Queue& queue) {
+	const size_t threads = state.range(0);
+	const size_t tasks = 1 << 14;
+	for(auto _: state) {
+		std::vector<std::thread> consumers{};
+		for(size_t c = 0; c < threads; ++c) {
+			consumers.emplace_back([&queue]() {
+					while(auto task = queue.wait_and_pop()) {
+						benchmark::DoNotOptimize(std::get<1>(*task));
+					}
+					});
+		}
+		std::vector<std::thread> producers{};
+		for(size_t p = 0; p < threads; ++p) {
+			producers.emplace_back([&queue, tasks]() {
+					for(size_t i = 0; i < tasks; ++i) {
+						queue.push({std::string("chunk"), i, 5});
+					}
+					});
+		}
+		for(auto& thread: producers) {
+			thread.join();
+		}
+		queue.close();
+		for(auto& thread: consumers) {
+			thread.join();
+		}
+		queue.reopen();
+	}
+	state.SetItemsProcessed(state.iterations() * threads * tasks);
+}
+
+static void BM_task_queue(benchmark::State& state) {
+	libs::safe_datastructure::task_queue<std::string, size_t> queue(256);
+	run_producers_consumers(state, queue);
+}
+BENCHMARK(BM_task_queue)->Arg(1)->Arg(2)->Arg(4)->UseRealTime();
+
+static void BM_ring_buffer(benchmark::State& state) {
+	libs::safe_datastructure::mpmc_ring_buffer<std::string, size_t> queue(256);
+	run_producers_consumers(state, queue);
+}
+BENCHMARK(BM_ring_buffer)->Arg(1)->Arg(2)->Arg(4)->UseRealTime();
+
+/*
+ * Every 16th task is 64 times as expensive as the others, the way the dense smiley regions or the long tokens are.
+ */
+static void skewed_work(size_t task) {
+	const size_t rounds = (task % 16 == 0) ? 64 * 256 : 256;
+	size_t acc = task;
+	for(size_t i = 0; i < rounds; ++i) {
+		acc = acc * 6364136223846793005ull + 1442695040888963407ull;
+	}
+	benchmark::DoNotOptimize(acc);
+}
+
+static void BM_skewed_shared_queue(benchmark::State& state) {
+	const size_t threads = state.range(0);
+	const size_t tasks = 1 << 12;
+	libs::safe_datastructure::mpmc_ring_buffer<std::string, size_t> queue(256);
+	for(auto _: state) {
+		std::vector<std::thread> workers{};
+		for(size_t w = 0; w < threads; ++w) {
+			workers.emplace_back([&queue]() {
+					while(auto task = queue.wait_and_pop()) {
+						skewed_work(std::get<1>(*task));
+					}
+					});
+		}
+		for(size_t i = 0; i < tasks; ++i) {
+			queue.push({std::string(), i, 0});
+		}
+		queue.close();
+		for(auto& thread: workers) {
+			thread.join();
+		}
+		queue.reopen();
+	}
+	state.SetItemsProcessed(state.iterations() * tasks);
+}
+BENCHMARK(BM_skewed_shared_queue)->Arg(1)->Arg(2)->Arg(4)->UseRealTime();
+
+static void BM_skewed_work_stealing(benchmark::State& state) {
+	const size_t threads = state.range(0);
+	const size_t tasks = 1 << 12;
+	for(auto _: state) {
+		libs::safe_datastructure::work_stealing_queue<size_t> queue(threads, 256);
+		std::vector<std::thread> workers{};
+		for(size_t w = 0; w < threads; ++w) {
+			workers.emplace_back([&queue, w]() {
+					while(auto task = queue.pop(w)) {
+						skewed_work(*task);
+					}
+					});
+		}
+		for(size_t i = 0; i < tasks; ++i) {
+			queue.push(size_t(i));
+		}
+		queue.close();
+		for(auto& thread: workers) {
+			thread.join();
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * tasks);
+}
+BENCHMARK(BM_skewed_work_stealing)->Arg(1)->Arg(2)->Arg(4)->UseRealTime();
@@ -0,0 +1,109 @@
+#include <benchmark/benchmark.h>
+#include <fcntl.h>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "async_file_reader.hpp"
+#include "corpus.hpp"
+#include "io_engine.hpp"
+#include "mapped_file.hpp"
+
+/*
+ * Evicts the corpus from the page cache when the range argument is set, so the reads hit the device.
+ */
+static void prepare_cache(benchmark::State& state) {
+	if(state.range(0) == 0) {
+		return;
+	}
+	state.PauseTiming();
+	const int fd = ::open(benchmarks::corpus_path().c_str(), O_RDONLY);
+	if(fd >= 0) {
+		fdatasync(fd);
+		posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+		::close(fd);
+	}
+	state.ResumeTiming();
+}
+
+static void BM_read_ifstream(benchmark::State& state) {
+	std::vector<char> buffer(libs::proccesing::async_file_reader::default_block_size);
+	size_t bytes = 0;
+	for(auto _: state) {
+		prepare_cache(state);
+		std::ifstream is(benchmarks::corpus_path(), std::ios::binary);
+		while(is.read(buffer.data(), buffer.size()) || is.gcount() > 0) {
+			bytes += is.gcount();
+			benchmark::DoNotOptimize(buffer.data());
+		}
+	}
+	state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_read_ifstream)->Arg(0)->Arg(1)->UseRealTime();
+
+static void BM_read_mmap(benchmark::State& state) {
+	size_t bytes = 0;
+	for(auto _: state) {
+		prepare_cache(state);
+		libs::proccesing::mapped_file file(benchmarks::corpus_path());
+		auto window = file.map(0, file.size());
+		const std::string_view data = window.get()->data();
+		size_t sum = 0;
+		for(size_t i = 0; i < data.size(); i += 4096) {
+			sum += data[i];
+		}
+		benchmark::DoNotOptimize(sum);
+		bytes += data.size();
+	}
+	state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_read_mmap)->Arg(0)->Arg(1)->UseRealTime();
+
+template <libs::proccesing::async_backend Backend, bool Direct>
+static void BM_read_async(benchmark::State& state) {
+	size_t bytes = 0;
+	for(auto _: state) {
+		prepare_cache(state);
+		libs::proccesing::async_file_reader file(benchmarks::corpus_path(), libs::proccesing::async_file_reader::default_block_size,
+				state.range(1), Backend, Direct);
+		while(std::optional<std::string_view> data = file.next()) {
+			benchmark::DoNotOptimize(data.value().data());
+			bytes += data.value().size();
+		}
+	}
+	state.SetBytesProcessed(bytes);
+}
+BENCHMARK_TEMPLATE(BM_read_async, libs::proccesing::async_backend::io_uring, true)->ArgsProduct({{0, 1}, {1, 3, 8}})->UseRealTime();
+BENCHMARK_TEMPLATE(BM_read_async, libs::proccesing::async_backend::pread, true)->ArgsProduct({{0, 1}, {1, 3, 8}})->UseRealTime();
+BENCHMARK_TEMPLATE(BM_read_async, libs::proccesing::async_backend::io_uring, false)->ArgsProduct({{0, 1}, {3}})->UseRealTime();
+
+/*
+ * The whole pipeline: the chunks of 64 KiB are counted by the workers while the file is being read.
+ */
+static void run_engine(benchmark::State& state, libs::proccesing::reader_type reader) {
+	size_t bytes = 0;
+	for(auto _: state) {
+		prepare_cache(state);
+		libs::proccesing::io_engine<std::string, size_t> engine(benchmarks::corpus_path(), 64 * 1024);
+		engine.set_reader(reader);
+		engine.read();
+		bytes += std::filesystem::file_size(benchmarks::corpus_path());
+	}
+	state.SetBytesProcessed(bytes);
+}
+
+static void BM_engine_ifstream(benchmark::State& state) {
+	run_engine(state, libs::proccesing::reader_type::stream);
+}
+BENCHMARK(BM_engine_ifstream)->Arg(0)->Arg(1)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+static void BM_engine_mmap(benchmark::State& state) {
+	run_engine(state, libs::proccesing::reader_type::mapped);
+}
+BENCHMARK(BM_engine_mmap)->Arg(0)->Arg(1)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+static void BM_engine_async(benchmark::State& state) {
+	run_engine(state, libs::proccesing::reader_type::async);
+}
+BENCHMARK(BM_engine_async)->Arg(0)->Arg(1)->UseRealTime()->Unit(benchmark::kMillisecond);
@@ -0,0 +1,33 @@
+#include <benchmark/benchmark.h>
+#include <regex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "corpus.hpp"
+#include "utils.hpp"
+
+static void BM_smileys_regex(benchmark::State& state) {
+	const std::string& text = benchmarks::corpus_text();
+	for(auto _: state) {
+		std::unordered_map<std::string, std::vector<size_t>> smileys{};
+		const std::regex pat("(:-?(\\)|\\}|\\]|\\(|\\{|\\[))");
+		for(std::sregex_iterator it(text.cbegin(), text.cend(), pat); it != std::sregex_iterator(); ++it) {
+			smileys[it->str()].push_back(it->position() + 1);
+		}
+		benchmark::DoNotOptimize(smileys.size());
+	}
+	state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_smileys_regex);
+
+static void BM_search_smileys(benchmark::State& state) {
+	const std::string& text = benchmarks::corpus_text();
+	for(auto _: state) {
+		std::unordered_map<std::string, std::vector<size_t>> smileys{};
+		libs::utils::search_smileys<std::string, size_t>(text, text.size(), smileys);
+		benchmark::DoNotOptimize(smileys.size());
+	}
+	state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_search_smileys);
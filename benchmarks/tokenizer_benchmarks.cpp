@@ -0,0 +1,74 @@
+#include <benchmark/benchmark.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "corpus.hpp"
+#include "utils.hpp"
+
+static void BM_split_by_any_of_special_character(benchmark::State& state) {
+	const std::string& text = benchmarks::corpus_text();
+	for(auto _: state) {
+		std::vector<std::string> words = libs::utils::split_by_any_of_special_character(text);
+		benchmark::DoNotOptimize(words.data());
+	}
+	state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_split_by_any_of_special_character);
+
+static void BM_boost_split(benchmark::State& state) {
+	const std::string& text = benchmarks::corpus_text();
+	for(auto _: state) {
+		std::vector<std::string> words{};
+		boost::split(words, text, boost::is_any_of(libs::utils::special_characters), boost::token_compress_on);
+		benchmark::DoNotOptimize(words.data());
+	}
+	state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_boost_split);
+
+static void BM_for_each_word(benchmark::State& state) {
+	const std::string& text = benchmarks::corpus_text();
+	for(auto _: state) {
+		size_t count = 0;
+		libs::utils::for_each_word(text, [&count](std::string_view word) {
+				count += word.size();
+				});
+		benchmark::DoNotOptimize(count);
+	}
+	state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_for_each_word);
+
+static void BM_split_kernel(benchmark::State& state) {
+	const std::string& text = benchmarks::corpus_text();
+	for(auto _: state) {
+		size_t count = 0;
+		std::unordered_map<std::string, std::vector<size_t>> smileys{};
+		libs::utils::search_smileys<std::string, size_t>(text, text.size(), smileys);
+		libs::utils::for_each_word(text, [&count](std::string_view word) {
+				count += word.size();
+				});
+		benchmark::DoNotOptimize(count);
+	}
+	state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_split_kernel);
+
+static void BM_fused_kernel(benchmark::State& state) {
+	const std::string& text = benchmarks::corpus_text();
+	for(auto _: state) {
+		size_t count = 0;
+		std::unordered_map<std::string, std::vector<size_t>> smileys{};
+		libs::utils::for_each_word_and_smiley(text, libs::utils::smiley_set::defaults(), 
+				[&count](std::string_view word) {
+				count += word.size();
+				},
+				[&smileys](size_t offset, std::string_view code) {
+				smileys[std::string(code)].push_back(offset + 1);
+				});
+		benchmark::DoNotOptimize(count);
+	}
+	state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_fused_kernel);
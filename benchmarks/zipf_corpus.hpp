@@ -0,0 +1,130 @@
+#ifndef __BENCHMARKS_ZIPF_CORPUS_HPP__
+#define __BENCHMARKS_ZIPF_CORPUS_HPP__
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <ostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace benchmarks {
+/**
+ * \brief Generates a synthetic text whose word frequencies follow Zipf's law, the word of rank `k` occurs
+ * proportionally to `1 / k^exponent`, like in a natural language. The frequent words are the short ones.
+ * The smileys are scattered among the words with the given density. The same arguments always give the same text,
+ * the random numbers come from `std::mt19937_64` and are turned into the samples without the standard distributions,
+ * whose results differ between the standard libraries.
+ */
+class zipf_corpus_generator {
+	public:
+		static constexpr size_t default_vocabulary_size = 100000;
+		static constexpr double default_exponent = 1.0;
+		/// The smileys per 1000 words
+		static constexpr double default_smiley_density = 1.0;
+		static constexpr uint64_t default_seed = 42;
+		/// Every smiley recognized by the analysis
+		static constexpr std::array<const char*, 12> smileys{":)", ":}", ":]", ":(", ":{", ":[",
+			":-)", ":-}", ":-]", ":-(", ":-{", ":-["};
+	private:
+		std::vector<std::string> m_vocabulary{};
+		std::vector<double> m_cdf{};
+		double m_smiley_probability{0.0};
+		std::mt19937_64 m_rng{};
+	private:
+		/*
+		 * The word of the rank in the bijective base 26: a, ..., z, aa, ab, ...
+		 */
+		static std::string word_of_rank(size_t rank) {
+			std::string ret{};
+			for(size_t n = rank + 1; n > 0; n = (n - 1) / 26) {
+				ret.push_back(static_cast<char>('a' + (n - 1) % 26));
+			}
+			std::reverse(ret.begin(), ret.end());
+			return ret;
+		}
+		/*
+		 * The uniform sample in [0, 1) from the upper 53 bits
+		 */
+		double uniform() {
+			return static_cast<double>(m_rng() >> 11) * 0x1.0p-53;
+		}
+		const std::string& next_word() {
+			const auto it = std::upper_bound(m_cdf.begin(), m_cdf.end(), uniform());
+			return m_vocabulary[std::min<size_t>(it - m_cdf.begin(), m_vocabulary.size() - 1)];
+		}
+	public:
+		/**
+		 * Constructor with arguments
+		 * \param vocabulary_size the number of the distinct words
+		 * \param exponent the exponent of the distribution, the higher the more skewed
+		 * \param smiley_density the average number of the smileys per 1000 words
+		 * \param seed the seed of the random numbers
+		 */
+		explicit zipf_corpus_generator(size_t vocabulary_size = default_vocabulary_size,
+				double exponent = default_exponent,
+				double smiley_density = default_smiley_density,
+				uint64_t seed = default_seed):
+			m_smiley_probability(std::clamp(smiley_density / 1000.0, 0.0, 1.0)),
+			m_rng(seed) {
+			vocabulary_size = std::max<size_t>(vocabulary_size, 1);
+			m_vocabulary.reserve(vocabulary_size);
+			m_cdf.reserve(vocabulary_size);
+			double total = 0.0;
+			for(size_t rank = 0; rank < vocabulary_size; ++rank) {
+				m_vocabulary.push_back(word_of_rank(rank));
+				total += 1.0 / std::pow(static_cast<double>(rank + 1), exponent);
+				m_cdf.push_back(total);
+			}
+			for(double& p: m_cdf) {
+				p /= total;
+			}
+		}
+		/**
+		 * Writes the text of the given size, the words are separated by the spaces and the lines have about 12 words
+		 * \param os the output stream
+		 * \param size the number of the bytes to write
+		 */
+		void write(std::ostream& os, size_t size) {
+			std::string line{};
+			size_t written = 0;
+			size_t words = 0;
+			while(written < size) {
+				if(uniform() < m_smiley_probability) {
+					line += smileys[m_rng() % smileys.size()];
+				} else {
+					line += next_word();
+				}
+				line.push_back(++words % 12 == 0 ? '\n' : ' ');
+				if(line.size() >= 64 * 1024 || written + line.size() >= size) {
+					const size_t count = std::min(line.size(), size - written);
+					os.write(line.data(), count);
+					written += count;
+					line.clear();
+				}
+			}
+		}
+		/**
+		 * Generates the text of the given size
+		 * \param size the number of the bytes
+		 * @returns `std::string`
+		 */
+		std::string generate(size_t size) {
+			std::ostringstream os;
+			write(os, size);
+			return os.str();
+		}
+		/**
+		 * Gets the distinct words, ordered by the rank
+		 * @returns `const std::vector<std::string>&`
+		 */
+		const std::vector<std::string>& vocabulary() const {
+			return m_vocabulary;
+		}
+};
+}
+
+#endif // __BENCHMARKS_ZIPF_CORPUS_HPP__
@@ -1,6 +1,12 @@
+#include <algorithm>
 #include <boost/program_options.hpp>
+#include <cctype>
+#include <chrono>
+#include <csignal>
 #include <iostream>
+#include <sstream>
 #include <variant>
+#include <vector>
 
 #include "io_engine.hpp"
 #include "report_generator.hpp"
@@ -13,17 +19,44 @@ std::variant<po::variables_map, size_t> argparse(int argc, char** argv) {
 	po::options_description arg_desc("Options");
 	arg_desc.add_options()
 		("help,h", "Show usage")
-		("chunk_size,c", po::value<size_t>(), "Indicates in which portions the input text file should be processed.")
-		("input_file_path,i", po::value<std::string>(), "The Input file path.")
+		("chunk_size,c", po::value<std::string>(), "Indicates in which portions the input text file should be processed, auto tunes the size at runtime.")
+		("input_file_path,i", po::value<std::vector<std::string>>()->multitoken()->composing()->required(), 
+		 "The Input file paths, directories or file name patterns, - reads the standard input.")
 		("db_path,d", po::value<std::string>(), "Indicates the database file full path if it is going to be used.")
 		("top,n", po::value<size_t>(), "Gets n most frequent words.")
 		("output_format,f", po::value<std::string>(), "Indicates in which format to represent the output.")
-		("output_file_path,o", po::value<std::string>(), "The output file path.");
+		("output_file_path,o", po::value<std::string>(), "The output file path.")
+		("workers,w", po::value<size_t>(), "The number of worker threads, defaults to the number of hardware threads.")
+		("reader,r", po::value<std::string>(), "The way the input file is read [ifstream | mmap | parallel | uring | pread | forward], defaults to ifstream.")
+		("smileys", po::value<std::string>(), "Additional emoticons to search for separated by spaces, e.g. \";) :D\".")
+		("kernel", po::value<std::string>(), "The way the chunks are mined [split | fused], defaults to split.")
+		("db_batch", po::value<size_t>(), "The number of chunks written to the database in a single transaction, defaults to 16.")
+		("resume", "Counts only the lines appended to the input file since the previous run into the statistics kept in the database.")
+		("follow", po::value<double>(), "Follows the growing input file and reports the statistics every given seconds until interrupted.")
+		("spill_dir", po::value<std::string>(), "Counts the words by the external aggregation, the sorted runs and the smileys are spilled to this directory.")
+		("memory_budget", po::value<size_t>(), "The memory budget of the word counting in MiB when spilling, defaults to 256.")
+		("memory_limit", po::value<size_t>(), "The memory limit of the word counts and the smileys in MiB, the words and the smileys are spilled only once it is exceeded.")
+		("scheduler", po::value<std::string>(), "The way the chunks are handed out to the workers [queue | stealing], defaults to queue.")
+		("readers", po::value<size_t>(), "The number of the threads of the parallel reader or the number of the files read at once, defaults to the number of workers.")
+		("io_depth", po::value<size_t>(), "The number of the reads in flight of the uring and pread readers, defaults to 3.")
+		("snapshot", po::value<std::string>(), "Writes the full statistics to this snapshot file, so they can be merged later.")
+		("stats", po::value<std::string>(), "Writes the JSON profile of the run to this file, - writes the standard error.");
 	try {
 		po::store(po::parse_command_line(argc, argv, arg_desc), vm);
-		po::notify(vm);
+		if(!vm.count("help")) {
+			po::notify(vm);
+			// -n and -f may be omitted only if the statistics are written to a snapshot
+			if(!vm.count("snapshot")) {
+				for(const std::string option: {"top", "output_format"}) {
+					if(!vm.count(option)) {
+						throw po::required_option("--" + option);
+					}
+				}
+			}
+		}
 		var = vm;
 	} catch(std::exception& ex) {
+		std::cout << "Usage error: " << ex.what() << "\n";
 		size_t status = 1;
 		var = status;
 	}
@@ -32,22 +65,214 @@ std::variant<po::variables_map, size_t> argparse(int argc, char** argv) {
 
 void usage(char** argv) {
 	std::cout << "Usage: " << argv[0] << " -c [chunk size] -i [input_file_path] -d [db_path]" << 
-		" -n [top] -f [output format] -o [output_file_path]" <<
-		"\nArguments descriptions:\n" << "\t-i | input_file_path, The Input file path\n" <<
+		" -n [top] -f [output format] -o [output_file_path] -w [workers] -r [reader] --smileys [emoticons] --kernel [kernel] --db_batch [chunks] --resume --follow [seconds] --spill_dir [directory] --memory_budget [MiB] --memory_limit [MiB] --scheduler [scheduler] --readers [readers] --io_depth [reads] --snapshot [snapshot_path] --stats [profile_path]" <<
+		"\n       " << argv[0] << " merge [snapshot_path ...] -n [top] -f [output format] -o [output_file_path] --snapshot [snapshot_path]" <<
+		"\nArguments descriptions:\n" << "\t-i | input_file_path, The Input file path, - reads the standard input. The pipes and the standard input are read forward only.\n" <<
+		"\t\tSeveral files, directories or file name patterns, e.g. \"logs/*.log\", are read concurrently into a single report,\n" <<
+		"\t\tthe smiley positions are qualified by the file then\n" <<
 		"\t-n | top, Gets n most frequent words\n" <<
 		"\t-f | output_format, supported formats [xml | file | console], Indicates in which format to represent the output\n" <<
 		"\nOptional Arguments:\n" <<
-		"\t-c | chunk_size, Indicates in which portions the input text file should be processed\n" <<
+		"\t-c | chunk_size, Indicates in which portions the input text file should be processed, auto tunes the size at runtime from the workers' throughput\n" <<
 		"\t-d | db_path, Indicates the database name if it is going to be used\n" <<
-		"\t-o | output_file_path, The output file path\n";
+		"\t-o | output_file_path, The output file path\n" <<
+		"\t-w | workers, The number of worker threads, defaults to the number of hardware threads\n" <<
+		"\t-r | reader, supported readers [ifstream | mmap | parallel | uring | pread | forward], Indicates how the input file is read, defaults to ifstream.\n" <<
+		"\t\turing and pread keep several direct reads in flight, uring falls back to pread if io_uring isn't available.\n" <<
+		"\t\tforward never seeks the input, it is always used for the standard input and the pipes\n" <<
+		"\t--smileys, Additional emoticons to search for separated by spaces, e.g. \";) :D\"\n" <<
+		"\t--kernel, supported kernels [split | fused], Indicates whether the chunks are tokenized and scanned for the smileys in one pass, defaults to split\n" <<
+		"\t--db_batch, The number of chunks written to the database in a single transaction, defaults to 16\n" <<
+		"\t--resume, Keeps the statistics in the database across the runs over an append-only file and counts only the complete lines\n" <<
+		"\t\tappended since the previous run, a crashed run resumes from its last committed batch. Requires -d\n" <<
+		"\t--follow, Follows the input file like tail -f: the appended lines are counted as soon as they are written and the report,\n" <<
+		"\t\tand the snapshot if set, are written every given seconds and once more when the process is interrupted\n" <<
+		"\t--spill_dir, Counts the words by the external aggregation, the sorted runs and the smileys are spilled to this directory\n" <<
+		"\t--memory_budget, The memory budget of the word counting in MiB when spilling, defaults to 256\n" <<
+		"\t--memory_limit, The memory limit of the word counts and the smileys in MiB, the words and the smileys are kept in the ram-memory\n" <<
+		"\t\tand spilled to --spill_dir or to the temporary directory only once the limit is exceeded\n" <<
+		"\t--scheduler, supported schedulers [queue | stealing], Indicates whether the workers share a single queue or steal the chunks from each other, defaults to queue\n" <<
+		"\t--readers, The number of the threads of the parallel reader, each reads its own byte range of the file, or the number of the files read at once, defaults to the number of workers\n" <<
+		"\t--io_depth, The number of the reads in flight of the uring and pread readers, defaults to 3\n" <<
+		"\t--snapshot, Writes the full statistics to this snapshot file, -n and -f may be omitted then.\n" <<
+		"\t\tThe merge command combines the snapshots of several runs, e.g. over the shards of a corpus, into a single report\n" <<
+		"\t\tand optionally into a merged snapshot\n" <<
+		"\t--stats, Writes the JSON profile of the run to this file, - writes the standard error: the throughput, the time of every stage\n" <<
+		"\t\tsummed over the threads, the queue depth and the lock wait histograms, the peak RSS and how the input was read\n";
 }
 
-int main(int argc, char** argv) {
-	if(argc < 7 || argc > 13) {
-		std::cout << "Invalid usage, please see the usage below.\n";
-		usage(argv);
+int generate_report(const po::variables_map& vm, const std::vector<std::pair<std::string, std::string>>& response, 
+		const std::vector<std::pair<std::string, std::string>>& smilyes) {
+	if(vm.count("output_format")) {
+		std::string format = vm["output_format"].as<std::string>();
+		if((format == "xml" || format == "file") && !vm.count("output_file_path")) {
+			std::cout << "Usage error: Missing output file path\n";
+			return 1;
+		}
+		std::string out_path = vm["output_file_path"].as<std::string>();
+		std::ofstream output(out_path);
+		namespace rgen = libs::report_generator;
+		namespace ut = libs::utils;
+		/*
+		 * No dynamic cast!
+		 * Unfortunately we can't apply type selection metaprogramming technique here as output format should be known at compile time.
+		 * Conceptually, there are 3 different types of generators and 3 different instances of report generators respectively.
+		 * The run-time is almost the same as in case of virtual call mechanism and so, a heterogenus container with visitor pattern applied seems more clean solution to me.
+		 */ 
+		std::variant<rgen::report_generator<rgen::xml_generator>, rgen::report_generator<rgen::out_file_generator>, rgen::report_generator<rgen::console_out>> gen;
+		if(format == "xml") {
+			gen.emplace<rgen::report_generator<rgen::xml_generator>>(response, smilyes);
+		} else if(format == "file") {
+			gen.emplace<rgen::report_generator<rgen::out_file_generator>>(response, smilyes);
+		} else if(format == "console") {
+			gen.emplace<rgen::report_generator<rgen::console_out>>(response, smilyes);
+		} else {
+			std::cout << "Usage error: Invalid output format: " << format << "\n";
+			return 1;
+		}
+		std::visit([&output](auto& v) {v.generate_logs(output);}, gen);
+	}
+	return 0;
+}
+
+/*
+ * Writes the profile collected by the engine if it was requested by --stats
+ */
+int write_profile(const po::variables_map& vm, libs::analysis::pipeline_profile* profile) {
+	if(!vm.count("stats") || profile == nullptr) {
+		return 0;
+	}
+	const std::string path = vm["stats"].as<std::string>();
+	if(path == "-") {
+		std::cerr << profile->to_json();
+		return 0;
+	}
+	std::ofstream output(path);
+	if(!output.is_open()) {
+		std::cout << "Error: Can't open the profile file: " << path << "\n";
+		return 1;
+	}
+	output << profile->to_json();
+	return 0;
+}
+
+volatile std::sig_atomic_t follow_stopped = 0;
+
+/*
+ * The follow mode: counts the lines appended to the input file and writes the report periodically until interrupted.
+ */
+int follow(const po::variables_map& vm, libs::proccesing::io_engine<std::string, size_t>& io_obj) {
+	if(!vm.count("top")) {
+		std::cout << "Usage error: frequency dosen't specified\n";
 		return 1;
 	}
+	const size_t top = vm["top"].as<size_t>();
+	const auto interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+			std::chrono::duration<double>(std::max(vm["follow"].as<double>(), 0.0)));
+	auto report = [&vm, &io_obj, top]() {
+		std::vector<std::pair<std::string, std::string>> response = 
+			io_obj.query_n_most_frequent(top, [](size_t n){return std::to_string(n);});
+		std::vector<std::pair<std::string, std::string>> smilyes = 
+			io_obj.get_smileys([](size_t n){return std::to_string(n);});
+		if(vm.count("snapshot")) {
+			io_obj.save_snapshot(vm["snapshot"].as<std::string>());
+		}
+		return generate_report(vm, response, smilyes);
+	};
+	std::signal(SIGINT, [](int) {
+			follow_stopped = 1;
+			});
+	std::signal(SIGTERM, [](int) {
+			follow_stopped = 1;
+			});
+	// the ranking is kept up to date by the reads, so a report doesn't scan all the counts
+	io_obj.track_top_n(top);
+	int status = 0;
+	auto last_report = std::chrono::steady_clock::now();
+	io_obj.follow([&report, &status, &last_report, interval]() {
+			const auto now = std::chrono::steady_clock::now();
+			if(now - last_report >= interval) {
+				last_report = now;
+				status = report();
+			}
+			return status == 0 && follow_stopped == 0;
+			});
+	if(status != 0) {
+		return status;
+	}
+	if(report() != 0) {
+		return 1;
+	}
+	return write_profile(vm, io_obj.get_profile());
+}
+
+/*
+ * The merge command: combines the snapshots and generates the usual report.
+ */
+int merge(int argc, char** argv) {
+	po::variables_map vm;
+	po::options_description arg_desc("Merge options");
+	arg_desc.add_options()
+		("help,h", "Show usage")
+		("top,n", po::value<size_t>(), "Gets n most frequent words.")
+		("output_format,f", po::value<std::string>(), "Indicates in which format to represent the output.")
+		("output_file_path,o", po::value<std::string>(), "The output file path.")
+		("snapshot", po::value<std::string>(), "Writes the merged statistics to this snapshot file.")
+		("snapshots", po::value<std::vector<std::string>>(), "The snapshot files to merge.");
+	po::positional_options_description positional;
+	positional.add("snapshots", -1);
+	try {
+		po::store(po::command_line_parser(argc, argv).options(arg_desc).positional(positional).run(), vm);
+		po::notify(vm);
+	} catch(std::exception& ex) {
+		std::cout << "Invalid usage: " << ex.what() << "\n";
+		return 1;
+	}
+	if(vm.count("help") || !vm.count("snapshots")) {
+		std::cout << "Usage error: No snapshots to merge\n";
+		return 1;
+	}
+	if(!vm.count("top") && !vm.count("snapshot")) {
+		std::cout << "Usage error: frequency dosen't specified\n";
+		return 1;
+	}
+	try {
+		using merger_type = libs::proccesing::snapshot_merger<size_t>;
+		std::vector<std::string> paths = vm["snapshots"].as<std::vector<std::string>>();
+		if(vm.count("snapshot")) {
+			const std::string merged_path = vm["snapshot"].as<std::string>();
+			merger_type(paths).write(merged_path);
+			// the report is generated from the merged snapshot, it is cheaper than merging again
+			paths = {merged_path};
+		}
+		if(!vm.count("top")) {
+			return 0;
+		}
+		merger_type merger(paths);
+		std::vector<std::pair<std::string, std::string>> response{};
+		for(const auto& [word, freq]: merger.top_n(vm["top"].as<size_t>())) {
+			response.push_back(std::make_pair("Word", word));
+			response.push_back(std::make_pair("Id", std::to_string(freq)));
+		}
+		std::vector<std::pair<std::string, std::string>> smilyes{};
+		for(const auto& [code, positions]: merger.smileys()) {
+			for(const auto pos: positions) {
+				const auto [input, local] = merger_type::split_position(pos);
+				smilyes.push_back(std::make_pair("Code", code));
+				smilyes.push_back(std::make_pair("Id", merger.inputs()[input] + ":" + std::to_string(local)));
+			}
+		}
+		return generate_report(vm, response, smilyes);
+	} catch(std::exception& exp) {
+		std::cout << exp.what() << "\n";
+		return 1;
+	}
+}
+
+int main(int argc, char** argv) {
+	if(argc > 1 && std::string(argv[1]) == "merge") {
+		return merge(argc - 1, argv + 1);
+	}
 	std::variant<po::variables_map, size_t> args_var = argparse(argc, argv);
 	auto type_var = std::get_if<po::variables_map>(&args_var);
 	if(type_var == nullptr) {
@@ -60,60 +285,143 @@ int main(int argc, char** argv) {
 		usage(argv);
 		return 1;
 	}
-	if(!vm.count("input_file_path")) { 
-		std::cout << "Usage error: Input file path dosen't specified\n";
-		return 1;
-	}
 	size_t chunk_size = 64;
+	bool adaptive_chunk_size = false;
 	if(vm.count("chunk_size")) {
-		chunk_size = vm["chunk_size"].as<size_t>();
+		const std::string chunk = vm["chunk_size"].as<std::string>();
+		if(chunk == "auto") {
+			adaptive_chunk_size = true;
+		} else {
+			// std::stoul takes a sign and stops at the first non-digit, so "-5" and "64k" are rejected here, as is an empty chunk
+			size_t parsed = 0;
+			try {
+				if(!chunk.empty() && std::isdigit(static_cast<unsigned char>(chunk.front()))) {
+					chunk_size = std::stoul(chunk, &parsed);
+				}
+			} catch(std::exception& ex) {
+				parsed = 0;
+			}
+			if(parsed == 0 || parsed != chunk.size() || chunk_size == 0) {
+				std::cout << "Usage error: Invalid chunk size: " << chunk << "\n";
+				return 1;
+			}
+		}
 	}
-	std::string input_path = vm["input_file_path"].as<std::string>();
+	const std::vector<std::string> input_args = vm["input_file_path"].as<std::vector<std::string>>();
 	try {
+		const std::vector<std::string> inputs = libs::utils::expand_input_paths(input_args);
+		if(inputs.empty()) {
+			std::cout << "Usage error: No input files found\n";
+			return 1;
+		}
+		if(std::find(inputs.begin(), inputs.end(), libs::proccesing::io_engine<std::string, size_t>::stdin_path) != inputs.end()) {
+			std::ios::sync_with_stdio(false);
+		}
 		std::string db_path{};
 		if(vm.count("db_path")) {
 			db_path = vm["db_path"].as<std::string>();
 		}
-		libs::proccesing::io_engine<std::string, size_t> io_obj(input_path, chunk_size, db_path);
+		size_t workers = 0;
+		if(vm.count("workers")) {
+			workers = vm["workers"].as<size_t>();
+		}
+		libs::proccesing::io_engine<std::string, size_t> io_obj(inputs.front(), chunk_size, db_path, workers);
+		if(inputs.size() > 1 || inputs != input_args) {
+			io_obj.set_inputs(inputs);
+		}
+		io_obj.set_adaptive_block_size(adaptive_chunk_size);
+		if(vm.count("reader")) {
+			std::string reader = vm["reader"].as<std::string>();
+			if(reader == "mmap") {
+				io_obj.set_reader(libs::proccesing::reader_type::mapped);
+			} else if(reader == "parallel") {
+				io_obj.set_reader(libs::proccesing::reader_type::parallel);
+			} else if(reader == "forward") {
+				io_obj.set_reader(libs::proccesing::reader_type::forward);
+			} else if(reader == "uring" || reader == "pread") {
+				io_obj.set_reader(libs::proccesing::reader_type::async);
+				size_t io_depth = libs::proccesing::async_file_reader::default_queue_depth;
+				if(vm.count("io_depth")) {
+					io_depth = vm["io_depth"].as<size_t>();
+				}
+				io_obj.set_async_io(reader == "uring" ? libs::proccesing::async_backend::io_uring : libs::proccesing::async_backend::pread, io_depth);
+			} else if(reader != "ifstream") {
+				std::cout << "Usage error: Invalid reader: " << reader << "\n";
+				return 1;
+			}
+		}
+		if(vm.count("readers")) {
+			io_obj.set_readers_count(vm["readers"].as<size_t>());
+		}
+		if(vm.count("smileys")) {
+			libs::utils::smiley_set smileys = libs::utils::smiley_set::defaults();
+			std::istringstream patterns(vm["smileys"].as<std::string>());
+			std::string pattern{};
+			while(patterns >> pattern) {
+				smileys.add(pattern);
+			}
+			io_obj.set_smileys(smileys);
+		}
+		if(vm.count("db_batch")) {
+			io_obj.set_db_batch_size(vm["db_batch"].as<size_t>());
+		}
+		if(vm.count("resume")) {
+			if(db_path.empty()) {
+				std::cout << "Usage error: --resume requires the database path\n";
+				return 1;
+			}
+			io_obj.set_resumable(true);
+		}
+		if(vm.count("memory_limit")) {
+			io_obj.set_memory_limit(vm["memory_limit"].as<size_t>() * 1024 * 1024, vm.count("spill_dir") ? vm["spill_dir"].as<std::string>() : "");
+		} else if(vm.count("spill_dir")) {
+			size_t memory_budget = 256;
+			if(vm.count("memory_budget")) {
+				memory_budget = vm["memory_budget"].as<size_t>();
+			}
+			io_obj.set_spill(vm["spill_dir"].as<std::string>(), memory_budget * 1024 * 1024);
+		}
+		if(vm.count("scheduler")) {
+			std::string scheduler = vm["scheduler"].as<std::string>();
+			if(scheduler == "stealing") {
+				io_obj.set_scheduler(libs::analysis::scheduler_type::work_stealing);
+			} else if(scheduler != "queue") {
+				std::cout << "Usage error: Invalid scheduler: " << scheduler << "\n";
+				return 1;
+			}
+		}
+		if(vm.count("kernel")) {
+			std::string kernel = vm["kernel"].as<std::string>();
+			if(kernel == "fused") {
+				io_obj.set_kernel(libs::analysis::analysis_kernel::fused);
+			} else if(kernel != "split") {
+				std::cout << "Usage error: Invalid kernel: " << kernel << "\n";
+				return 1;
+			}
+		}
+		io_obj.set_profiling(vm.count("stats") != 0);
+		if(vm.count("follow")) {
+			return follow(vm, io_obj);
+		}
 		io_obj.read();
-		if(!vm.count("top")) {
-			std::cout << "Usage error: frequency dosen't specified\n";
-			return 1;
+		if(vm.count("snapshot")) {
+			io_obj.save_snapshot(vm["snapshot"].as<std::string>());
+			if(!vm.count("top")) {
+				return write_profile(vm, io_obj.get_profile());
+			}
 		}
 		size_t top = vm["top"].as<size_t>();
 		std::vector<std::pair<std::string, std::string>> response = 
 			io_obj.query_n_most_frequent(top, [](size_t n){return std::to_string(n);});
 		std::vector<std::pair<std::string, std::string>> smilyes = 
 			io_obj.get_smileys([](size_t n){return std::to_string(n);});
-		if(vm.count("output_format")) {
-			std::string format = vm["output_format"].as<std::string>();
-			if((format == "xml" || format == "file") && !vm.count("output_file_path")) {
-				std::cout << "Usage error: Missing output file path\n";
-				return 1;
-			}
-			std::string out_path = vm["output_file_path"].as<std::string>();
-			std::ofstream output(out_path);
-			namespace rgen = libs::report_generator;
-			namespace ut = libs::utils;
-			/*
-			 * No dynamic cast!
-			 * Unfortunately we can't apply type selection metaprogramming technique here as output format should be known at compile time.
-			 * Conceptually, there are 3 different types of generators and 3 different instances of report generators respectively.
-			 * The run-time is almost the same as in case of virtual call mechanism and so, a heterogenus container with visitor pattern applied seems more clean solution to me.
-			 */ 
-			std::variant<rgen::report_generator<rgen::xml_generator>, rgen::report_generator<rgen::out_file_generator>, rgen::report_generator<rgen::console_out>> gen;
-			if(format == "xml") {
-				gen.emplace<rgen::report_generator<rgen::xml_generator>>(response, smilyes);
-			} else if(format == "file") {
-				gen.emplace<rgen::report_generator<rgen::out_file_generator>>(response, smilyes);
-			} else if(format == "console") {
-				gen.emplace<rgen::report_generator<rgen::console_out>>(response, smilyes);
-			} else {
-				std::cout << "Usage error: Invalid output format: " << format << "\n";
+		{
+			const libs::analysis::pipeline_profile::scoped_timer timer(io_obj.get_profile(), libs::analysis::pipeline_stage::report);
+			if(generate_report(vm, response, smilyes) != 0) {
 				return 1;
 			}
-			std::visit([&output](auto& v) {v.generate_logs(output);}, gen);
 		}
+		return write_profile(vm, io_obj.get_profile());
 	} catch(libs::exception::custom_exception& exp) {
 		std::cout << exp.what() << "\n";
 		return 1;
@@ -1,19 +1,64 @@
 #ifndef __ANALYZE_STATISTICS__
 #define __ANALYZE_STATISTICS__
 
+#include <algorithm>
+#include <atomic>
 #include <boost/algorithm/string.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <iostream>
 #include <memory>
 #include <mutex>
-#include <regex>
+#include <optional>
 #include <thread>
 #include <unordered_map>
 #include <vector>
-#include "task_queue.hpp"
+#include "flat_counter.hpp"
+#include "pipeline_profile.hpp"
+#include "position_list.hpp"
+#include "ring_buffer.hpp"
+#include "text_span.hpp"
 #include "utils.hpp"
+#include "work_stealing_queue.hpp"
 
 namespace libs {
 	namespace analysis {
 
+/**
+ * \brief Defines how a chunk of text is mined
+ */
+enum class analysis_kernel {
+	/// The chunk is scanned for the smileys and then tokenized, i.e. twice
+	split,
+	/// The chunk is tokenized and scanned for the smileys in a single pass
+	fused
+};
+
+/**
+ * \brief Defines how the chunks are handed out to the workers
+ */
+enum class scheduler_type {
+	/// All the workers consume a single shared queue
+	shared_queue,
+	/// Every worker has its own deque, an idle worker steals from the others
+	work_stealing
+};
+
+/**
+ * \brief The amount of the work the workers have done so far
+ */
+struct processing_progress {
+	/// The number of the processed chunks
+	size_t chunks{0};
+	/// The number of the processed bytes
+	size_t bytes{0};
+	/// The total time the workers spent processing the chunks
+	std::chrono::nanoseconds busy_time{0};
+};
+
 /**
  * \brief Defines the main engine which is responsible for mining the required usefull information.
  * \tparam T the type of data stored in the map as a key
@@ -22,63 +67,528 @@ namespace libs {
 template <typename T, typename U>
 class analyze_stats_engine
 {
+	public:
+		using word_freq_map = std::unordered_map<T, U>;
+		/// The positions of a smiley are kept delta encoded, so the chunks' lists are appended by copying their bytes
+		using smileys_map = std::unordered_map<T, libs::datastructure::position_list<U>>;
+		/// The open addressing table the words are counted into
+		using counter_type = libs::datastructure::flat_counter<T, U>;
+		/// Gets the results of a chunk, the global position of the chunk's end and its length
+		using chunk_observer = std::function<void(const counter_type&, const smileys_map&, U, size_t)>;
+		/// Takes over a worker's table and smileys which have exceeded the memory budget
+		using spill_handler = std::function<void(const counter_type&, const smileys_map&)>;
+		/// The task queue holds the chunk of text, the global position of it's end and the length of that text
+		using queue_type = libs::safe_datastructure::mpmc_ring_buffer<libs::utils::text_span, U>;
+		using stealing_queue_type = libs::safe_datastructure::work_stealing_queue<typename queue_type::value_type>;
 	private:
-		std::unordered_map<T, U> m_word_freq{};
-		std::unordered_map<T, std::vector<U>> m_smileys{};
-		std::unique_ptr<libs::safe_datastructure::task_queue<T, U>> m_queue{};
+		/*
+		 * An entry of the worker's table scattered into a partition, the key refers to the worker's table arena.
+		 */
+		struct partition_entry {
+			std::string_view key;
+			size_t hash;
+			U value;
+		};
+		/*
+		 * The results owned by a single worker, the workers never share their tables,
+		 * so counting takes no locks. Aligned to avoid false sharing between the neighbour workers.
+		 */
+		struct alignas(64) worker_state {
+			counter_type word_freq{};
+			smileys_map smileys{};
+			std::vector<std::vector<partition_entry>> partitions{};
+			stage_times times{};
+			size_t chunks{0};
+			size_t bytes{0};
+			size_t tokens{0};
+			/// The footprint of the tables last added to the engine's total
+			size_t footprint{0};
+		};
+		counter_type m_word_freq{};
+		smileys_map m_smileys{};
+		std::unique_ptr<queue_type> m_queue{};
+		std::unique_ptr<stealing_queue_type> m_stealing_queue{};
+		scheduler_type m_scheduler{scheduler_type::shared_queue};
+		std::vector<libs::safe_datastructure::worker_stats> m_scheduler_stats{};
+		std::atomic<size_t> m_chunks_done{0};
+		std::atomic<size_t> m_bytes_done{0};
+		std::atomic<int64_t> m_busy_ns{0};
 		std::vector<std::thread> m_threads{};
+		std::vector<worker_state> m_states{};
+		size_t m_workers_count{};
+		chunk_observer m_observer{};
+		spill_handler m_spill_handler{};
+		size_t m_spill_threshold{0};
+		size_t m_memory_limit{0};
+		std::atomic<size_t> m_footprint{0};
+		std::atomic<size_t> m_peak_footprint{0};
+		std::atomic<bool> m_over_limit{false};
+		libs::utils::smiley_set m_smiley_set{libs::utils::smiley_set::defaults()};
+		analysis_kernel m_kernel{analysis_kernel::split};
+		pipeline_profile* m_profile{nullptr};
+		std::exception_ptr m_error{};
 		std::mutex m_mtx;
 		std::condition_variable m_cv;	
+	private:
+		/*
+		 * Mines the chunk and returns the number of its words, the stages are timed into `state` if the profile is set.
+		 */
+		size_t count_chunk(std::string_view text, U end, counter_type& word_freq, smileys_map& smileys, worker_state& state) {
+			size_t tokens = 0;
+			auto start = m_profile ? pipeline_profile::clock::now() : pipeline_profile::clock::time_point{};
+			if(m_kernel == analysis_kernel::fused) {
+				const U base = end - text.size() + 1;
+				libs::utils::for_each_word_and_smiley(text, m_smiley_set, 
+						[&word_freq, &tokens](std::string_view word) {
+						word_freq.add(word, 1);
+						++tokens;
+						}, 
+						[&smileys, base](size_t offset, std::string_view code) {
+						smileys[T(code)].push_back(base + offset);
+						});
+				if(m_profile) {
+					state.times.add(pipeline_stage::tokenize, pipeline_profile::clock::now() - start);
+				}
+				return tokens;
+			}
+			libs::utils::search_smileys(text, end, smileys, m_smiley_set);
+			if(m_profile) {
+				const auto now = pipeline_profile::clock::now();
+				state.times.add(pipeline_stage::smileys, now - start);
+				start = now;
+			}
+			libs::utils::for_each_word(text, [&word_freq, &tokens](std::string_view word) {
+					word_freq.add(word, 1);
+					++tokens;
+					});
+			if(m_profile) {
+				state.times.add(pipeline_stage::tokenize, pipeline_profile::clock::now() - start);
+			}
+			return tokens;
+		}
+		void push(typename queue_type::value_type&& task) {
+			if(m_profile) {
+				m_profile->record_queue_depth(get_pending_count());
+			}
+			const pipeline_profile::scoped_timer timer(m_profile, pipeline_stage::submit_wait);
+			if(m_stealing_queue) {
+				m_stealing_queue.get()->push(std::move(task));
+			} else if(m_queue) {
+				m_queue.get()->push(std::move(task));
+			}
+		}
+		void keep_error() {
+			std::lock_guard<std::mutex> lck(m_mtx);
+			if(!m_error) {
+				m_error = std::current_exception();
+			}
+		}
+		/*
+		 * Hands the worker's table and smileys over to the spill handler and starts new ones.
+		 */
+		void spill(worker_state& state) {
+			const auto start = pipeline_profile::clock::now();
+			try {
+				m_spill_handler(state.word_freq, state.smileys);
+			} catch(...) {
+				keep_error();
+			}
+			state.word_freq.clear();
+			state.smileys.clear();
+			state.times.add(pipeline_stage::spill, pipeline_profile::clock::now() - start);
+		}
+		/*
+		 * Whether the workers spill their tables, i.e. the spilling isn't deferred by the memory limit or the limit has been exceeded.
+		 */
+		bool spilling() const {
+			return m_spill_handler && (m_memory_limit == 0 || m_over_limit.load(std::memory_order_relaxed));
+		}
+		/*
+		 * Gets the footprint of the worker's table and smileys.
+		 */
+		static size_t worker_footprint(const worker_state& state) {
+			size_t ret = state.word_freq.memory_usage();
+			for(const auto& [code, positions]: state.smileys) {
+				ret += positions.memory_usage();
+			}
+			return ret;
+		}
+		/*
+		 * Adds the change of the worker's footprint to the total and switches to the spilling once the total exceeds the limit.
+		 */
+		void track_footprint(worker_state& state) {
+			const size_t footprint = worker_footprint(state);
+			const size_t total = m_footprint.fetch_add(footprint - state.footprint, std::memory_order_relaxed) + footprint - state.footprint;
+			state.footprint = footprint;
+			size_t peak = m_peak_footprint.load(std::memory_order_relaxed);
+			while(total > peak && !m_peak_footprint.compare_exchange_weak(peak, total, std::memory_order_relaxed)) {
+			}
+			if(total > m_memory_limit) {
+				m_over_limit.store(true, std::memory_order_relaxed);
+			}
+		}
+		std::optional<typename queue_type::value_type> next_task(size_t id) {
+			if(m_stealing_queue) {
+				return m_stealing_queue.get()->pop(id);
+			}
+			return m_queue.get()->wait_and_pop();
+		}
+		void worker(size_t id) {
+			worker_state& state = m_states[id];
+			while(auto front = next_task(id)) {
+				const auto chunk_start = std::chrono::steady_clock::now();
+				const std::string_view text = std::get<0>(*front).view();
+				if(!m_observer) {
+					state.tokens += count_chunk(text, std::get<1>(*front), state.word_freq, state.smileys, state);
+				} else {
+					counter_type local_word_freq{};
+					smileys_map local_smileys{};
+					state.tokens += count_chunk(text, std::get<1>(*front), local_word_freq, local_smileys, state);
+					try {
+						m_observer(local_word_freq, local_smileys, std::get<1>(*front), text.size());
+					} catch(...) {
+						keep_error();
+					}
+					state.word_freq.merge(local_word_freq);
+					for(const auto& [code, positions]: local_smileys) {
+						state.smileys[code].append(positions);
+					}
+				}
+				if(m_memory_limit != 0) {
+					track_footprint(state);
+				}
+				if(spilling() && worker_footprint(state) > m_spill_threshold) {
+					spill(state);
+					if(m_memory_limit != 0) {
+						track_footprint(state);
+					}
+				}
+				const auto busy = std::chrono::steady_clock::now() - chunk_start;
+				m_busy_ns.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(busy).count(), std::memory_order_relaxed);
+				m_bytes_done.fetch_add(text.size(), std::memory_order_relaxed);
+				m_chunks_done.fetch_add(1, std::memory_order_release);
+				++state.chunks;
+				state.bytes += text.size();
+			}
+			if(spilling() && (!state.word_freq.empty() || !state.smileys.empty())) {
+				spill(state);
+			}
+			if(m_profile) {
+				m_profile->add(state.times);
+				m_profile->add_work(state.chunks, state.bytes, state.tokens);
+			}
+			scatter(state);
+		}
+		/*
+		 * Splits the worker's table by the key hash, so every partition can be merged by a separate thread.
+		 */
+		void scatter(worker_state& state) {
+			const size_t partitions_count = m_states.size();
+			state.partitions.assign(partitions_count, {});
+			// the partition is taken from the upper half of the hash, the tables index their slots by the lower bits
+			state.word_freq.for_each_hashed([&state, partitions_count](std::string_view key, size_t hash, U value) {
+					state.partitions[(hash >> (sizeof(size_t) * 4)) % partitions_count].push_back({key, hash, value});
+					});
+		}
+		/*
+		 * Merges the per-worker results: each partition is reduced by its own thread,
+		 * then the disjoint partitions are added to the engine's table.
+		 */
+		void merge() {
+			const pipeline_profile::scoped_timer timer(m_profile, pipeline_stage::merge);
+			const size_t partitions_count = m_states.size();
+			std::vector<counter_type> merged(partitions_count);
+			std::vector<std::thread> threads{};
+			for(size_t p = 0; p < partitions_count; ++p) {
+				threads.emplace_back([this, p, &merged]() {
+						counter_type& dest = merged[p];
+						// the entries come in the order of the workers' slots, a growing table would cluster them
+						size_t count = 0;
+						for(const auto& state: m_states) {
+							count += state.partitions[p].size();
+						}
+						dest.reserve(count);
+						for(auto& state: m_states) {
+							for(const partition_entry& entry: state.partitions[p]) {
+								dest.add(entry.key, entry.hash, entry.value);
+							}
+							std::vector<partition_entry>().swap(state.partitions[p]);
+						}
+						});
+			}
+			for(auto& thread: threads) {
+				thread.join();
+			}
+			for(auto& state: m_states) {
+				for(auto& [code, positions]: state.smileys) {
+					m_smileys[code].append(positions);
+					positions.clear();
+				}
+			}
+			m_states.clear();
+			if(m_word_freq.empty() && partitions_count == 1) {
+				m_word_freq = std::move(merged.front());
+			} else {
+				size_t total = m_word_freq.size();
+				for(auto& part: merged) {
+					total += part.size();
+				}
+				m_word_freq.reserve(total);
+				for(auto& part: merged) {
+					m_word_freq.merge(part);
+					part.clear();
+				}
+			}
+			for(auto& [code, positions]: m_smileys) {
+				positions.sort();
+			}
+		}
 	public:
 		/**
-		 * Constructor with an argument
+		 * Gets the default number of workers, i.e. the number of hardware threads
+		 * @returns `size_t`
+		 */
+		static size_t default_workers_count() {
+			const size_t count = std::thread::hardware_concurrency();
+			return count == 0 ? 1 : count;
+		}
+		/**
+		 * Constructor with arguments
 		 * \param queue the which holds the pending tasks
+		 * \param workers_count the number of long-lived worker threads consuming the queue, `0` means `default_workers_count()`
 		 */
-		analyze_stats_engine(std::unique_ptr<libs::safe_datastructure::task_queue<T, U>> queue): 
-			m_queue(std::move(queue)) {}
+		analyze_stats_engine(std::unique_ptr<queue_type> queue, size_t workers_count = 0): 
+			m_queue(std::move(queue)),
+			m_workers_count(workers_count == 0 ? default_workers_count() : workers_count) {}
 		/**
-		 * Destructor
+		 * Destructor, stops the workers if they are still running
 		 */
 		~analyze_stats_engine() {
+			try {
+				wait();
+			} catch(std::exception& exp) {
+				std::cout << "Error: " << exp.what() << "\n";
+			} catch(...) {
+				std::cout << "Error: Undefined exception" << "\n";
+			}
+		}
+		/**
+		 * Sets a callback which is invoked by the worker with the results of each processed chunk.
+		 * Should be set before `start`, the callback is called concurrently from several workers.
+		 * \param observer the callback
+		 * @returns `void`
+		 */
+		void set_chunk_observer(chunk_observer&& observer) {
+			m_observer = std::move(observer);
+		}
+		/**
+		 * Bounds the memory of the workers' tables: once a worker's table and smileys exceed the threshold they are passed
+		 * to the handler and the worker starts counting from scratch. The handler also receives the remainders
+		 * when the workers finish, so the engine's own table and smileys stay empty.
+		 * Should be set before `start`, the handler is called concurrently from several workers.
+		 * \param worker_threshold the memory budget of a single worker's table and smileys in bytes
+		 * \param handler the callback
+		 * @returns `void`
+		 */
+		void set_spill_handler(size_t worker_threshold, spill_handler&& handler) {
+			m_spill_threshold = worker_threshold;
+			m_spill_handler = std::move(handler);
+		}
+		/**
+		 * Defers the spilling until the footprint of the workers' tables and smileys exceeds the limit, so the runs
+		 * which fit into the ram-memory never touch the disk. Once the limit is exceeded the workers spill the tables
+		 * above their threshold at once and their remainders when they finish. Should be set before `start`
+		 * together with `set_spill_handler`.
+		 * \param limit the limit in bytes, `0` spills as soon as a table exceeds the threshold
+		 * \param baseline the footprint of the results kept by the caller which counts against the limit
+		 * @returns `void`
+		 */
+		void set_memory_limit(size_t limit, size_t baseline = 0) {
+			m_memory_limit = limit;
+			m_footprint = baseline;
+			m_peak_footprint = baseline;
+			m_over_limit = limit != 0 && baseline > limit;
+		}
+		/**
+		 * Checks whether the memory limit has been exceeded, so the workers have switched to the spilling
+		 * @returns `bool`
+		 */
+		bool is_over_memory_limit() const {
+			return m_over_limit.load(std::memory_order_relaxed);
+		}
+		/**
+		 * Gets the peak footprint of the workers' tables and smileys tracked under the memory limit
+		 * @returns `size_t` the number of the bytes, `0` if there is no limit
+		 */
+		size_t get_peak_footprint() const {
+			return m_memory_limit == 0 ? 0 : m_peak_footprint.load(std::memory_order_relaxed);
+		}
+		/**
+		 * Sets the profile the workers and the readers record their stages into, should be set before `start`
+		 * \param profile the profile which outlives the run, `nullptr` turns the profiling off
+		 * @returns `void`
+		 */
+		void set_profile(pipeline_profile* profile) {
+			m_profile = profile;
+		}
+		/**
+		 * Sets the emoticons the workers search for, should be set before `start`
+		 * \param set the emoticons
+		 * @returns `void`
+		 */
+		void set_smileys(const libs::utils::smiley_set& set) {
+			m_smiley_set = set;
+		}
+		/**
+		 * Selects the way the chunks are mined, should be set before `start`
+		 * \param kernel the kernel
+		 * @returns `void`
+		 */
+		void set_kernel(analysis_kernel kernel) {
+			m_kernel = kernel;
+		}
+		/**
+		 * Selects the way the chunks are handed out to the workers, should be set before `start`
+		 * \param scheduler the scheduler
+		 * @returns `void`
+		 */
+		void set_scheduler(scheduler_type scheduler) {
+			m_scheduler = scheduler;
+		}
+		/**
+		 * Gets the way the chunks are handed out to the workers
+		 * @returns `scheduler_type`
+		 */
+		scheduler_type get_scheduler() const {
+			return m_scheduler;
+		}
+		/**
+		 * Gets the per-worker statistics of the last batch run by the work stealing scheduler
+		 * @returns `std::vector<libs::safe_datastructure::worker_stats>` which is empty for the shared queue
+		 */
+		const std::vector<libs::safe_datastructure::worker_stats>& get_scheduler_stats() const {
+			return m_scheduler_stats;
+		}
+		/**
+		 * Gets the way the chunks are mined
+		 * @returns `analysis_kernel`
+		 */
+		analysis_kernel get_kernel() const {
+			return m_kernel;
+		}
+		/**
+		 * Spawns the worker threads which keep consuming the task queue until `wait` is called
+		 * @returns `void`
+		 */
+		void start() {
+			if(!m_queue || !m_threads.empty()) {
+				return;
+			}
+			m_queue.get()->reopen();
+			if(m_scheduler == scheduler_type::work_stealing) {
+				m_stealing_queue = std::make_unique<stealing_queue_type>(m_workers_count, m_queue.get()->capacity());
+			}
+			m_states = std::vector<worker_state>(m_workers_count);
+			for(size_t i = 0; i < m_workers_count; ++i) {
+				m_threads.emplace_back(&analyze_stats_engine::worker, this, i);
+			}
+		}
+		/**
+		 * Pushes a task into the queue, so it is picked up by the first free worker
+		 * \param task holds input text, the global position of it's end and the length of that text
+		 * @returns `void`
+		 */
+		void submit(std::tuple<T, U, U>&& task) {
+			libs::utils::text_span span(std::move(std::get<0>(task)));
+			push({std::move(span), std::get<1>(task), std::get<2>(task)});
+		}
+		/**
+		 * Pushes a task into the queue without copying the text, the span keeps the referred buffer alive
+		 * \param span the chunk of text
+		 * \param end the global position of the chunk's end
+		 * @returns `void`
+		 */
+		void submit(libs::utils::text_span&& span, U end) {
+			const U length = span.length();
+			push({std::move(span), end, length});
+		}
+		/**
+		 * Closes the task queue, waits until the workers drain it and merges the workers' results.
+		 * Rethrows the first exception raised by the chunk observer or the spill handler, if any.
+		 * @returns `void`
+		 */
+		void wait() {
+			if(m_threads.empty()) {
+				return;
+			}
+			m_queue.get()->close();
+			if(m_stealing_queue) {
+				m_stealing_queue.get()->close();
+			}
+			for(auto& thread: m_threads) {
+				thread.join();
+			}
+			m_threads.clear();
+			m_queue.get()->reopen();
+			if(m_stealing_queue) {
+				m_scheduler_stats = m_stealing_queue.get()->get_stats();
+				m_stealing_queue.reset();
+			}
+			merge();
+			if(m_error) {
+				std::exception_ptr error = m_error;
+				m_error = nullptr;
+				std::rethrow_exception(error);
+			}
 		}
 		/**
 		 * Extracts the tasks from task queue and mines the required information i.e. smileys and their positions, words and their freequencies.
 		 * @returns `void`
 		 */
 		void analyze() {
-			if(m_queue) {
-				size_t size = m_queue.get()->size();
-				for(int i = 0; i < size; ++i) {
-					m_threads.emplace_back(std::thread([this]()
-					{
-						if(m_queue) {
-						    auto front = m_queue.get()->pop();
-						    m_mtx.lock();
-						    libs::utils::search_smileys<T, U>(*front.get(), m_smileys);
-						    m_mtx.unlock();
-						    std::vector<T> words = libs::utils::split_by_any_of_special_character(std::get<0>(*front.get()));
-						    for(auto& word: words) {
-						        m_mtx.lock();
-							if(!word.empty()) {
-							    ++m_word_freq[word];
-							}
-							m_mtx.unlock();
-						    }
-						}
-                                          
-					  ;})
-					);
-				}
-				for(int i = 0; i < m_threads.size(); ++i) {
-					m_threads[i].join();
-				}
+			start();
+			wait();
+		}
+		/**
+		 * Gets the amount of the work done since the engine was created, may be called while the workers are running
+		 * @returns `processing_progress`
+		 */
+		processing_progress get_progress() const {
+			processing_progress ret{};
+			ret.chunks = m_chunks_done.load(std::memory_order_acquire);
+			ret.bytes = m_bytes_done.load(std::memory_order_relaxed);
+			ret.busy_time = std::chrono::nanoseconds(m_busy_ns.load(std::memory_order_relaxed));
+			return ret;
+		}
+		/**
+		 * Gets the number of the chunks waiting for a worker
+		 * @returns `size_t`
+		 */
+		size_t get_pending_count() const {
+			if(m_stealing_queue) {
+				return m_stealing_queue.get()->size();
 			}
+			return m_queue ? m_queue.get()->size() : 0;
+		}
+		/**
+		 * Gets the maximum number of the chunks waiting for a worker
+		 * @returns `size_t`
+		 */
+		size_t get_queue_capacity() const {
+			return m_queue ? m_queue.get()->capacity() : 0;
+		}
+		/**
+		 * Gets the number of worker threads
+		 * @returns `size_t`
+		 */
+		size_t get_workers_count() const {
+			return m_workers_count;
 		}
 		/**
 		 * Gets the task queue
 		 * @returns task queue object
 		 */
-		std::unique_ptr<libs::safe_datastructure::task_queue<T, U>> get_task_queue() {
+		std::unique_ptr<queue_type> get_task_queue() {
 			return std::move(m_queue);
 		}
 		/**
@@ -86,14 +596,39 @@ class analyze_stats_engine
 		 * @returns `std::unordered_map<T, U>` where keys are the words and the values are their frequencies
 		 */
 		std::unordered_map<T, U> get_map() {
+			return m_word_freq.to_map();
+		}
+		/**
+		 * Gets the word-frequency table
+		 * @returns `const counter_type&` where keys are the words and the values are their frequencies
+		 */
+		const counter_type& get_counter() const {
 			return m_word_freq;
 		}
+		/**
+		 * Moves out the word-frequency table, the engine's table becomes empty
+		 * @returns `counter_type` where keys are the words and the values are their frequencies
+		 */
+		counter_type take_counter() {
+			return std::move(m_word_freq);
+		}
 		/**
 		 * Gets a hash map which represents smileys and their positions in the input text
 		 * @returns `std::unordered_map<T, std::vector<U>>>` where the key is a smiley character and the value is it's positions
 		 */
 		std::unordered_map<T, std::vector<U>> get_smileys() {
-			return m_smileys;
+			std::unordered_map<T, std::vector<U>> ret{};
+			for(const auto& [code, positions]: m_smileys) {
+				ret.emplace(code, positions.to_vector());
+			}
+			return ret;
+		}
+		/**
+		 * Takes over the smileys and their positions, the positions are kept encoded
+		 * @returns `smileys_map` where the key is a smiley character and the value is it's positions
+		 */
+		smileys_map take_smileys() {
+			return std::move(m_smileys);
 		}
 };
 }
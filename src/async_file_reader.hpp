@@ -0,0 +1,518 @@
+#ifndef __ASYNC_FILE_READER_HPP__
+#define __ASYNC_FILE_READER_HPP__
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#if defined(_UNIX_) || defined(__unix__)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+// the headers which know IORING_OP_READ also define the opcode probe
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter) && defined(__NR_io_uring_register) && defined(IO_URING_OP_SUPPORTED)
+#define __ASYNC_FILE_READER_IO_URING__
+#endif
+#endif
+
+#include "exception.hpp"
+
+namespace libs {
+	namespace proccesing {
+/**
+ * @brief Defines the way the asynchronous reads are issued
+ */
+enum class async_backend {
+	/// Linux io_uring, the reads are queued to the kernel without any extra thread
+	io_uring,
+	/// A thread per buffer issues the blocking `pread` calls
+	pread
+};
+/**
+ * \brief Reads the file sequentially keeping several reads in flight, so the device queue never runs dry while the caller is busy.
+ * Every read fills its own aligned buffer, the buffers are handed out in the file order and reused for the reads further ahead,
+ * i.e. double/triple buffering. The file is opened with `O_DIRECT` if the file system allows it, which bypasses the page cache.
+ * io_uring is used where the kernel supports it, otherwise the reads are issued by `pread` on the helper threads.
+ */
+class async_file_reader {
+	public:
+		/// The alignment of the buffers, the offsets and the lengths of the direct reads
+		static constexpr size_t alignment = 4096;
+		/// The size of a single read
+		static constexpr size_t default_block_size = 1 << 20;
+		/// The number of the buffers, one is being processed while the others are being read
+		static constexpr size_t default_queue_depth = 3;
+	private:
+		struct aligned_deleter {
+			void operator()(char* ptr) const {
+				std::free(ptr);
+			}
+		};
+		struct slot {
+			std::unique_ptr<char, aligned_deleter> buffer{};
+			size_t offset{0};
+			size_t length{0};
+			size_t filled{0};
+			int error{0};
+			bool retried{false};
+			bool scheduled{false};
+			bool ready{false};
+		};
+#ifdef __ASYNC_FILE_READER_IO_URING__
+		/*
+		 * The submission and the completion rings shared with the kernel, set up by the raw system calls.
+		 */
+		class ring {
+			private:
+				int m_fd{-1};
+				void* m_sq_ptr{MAP_FAILED};
+				size_t m_sq_length{0};
+				void* m_cq_ptr{MAP_FAILED};
+				size_t m_cq_length{0};
+				io_uring_sqe* m_sqes{static_cast<io_uring_sqe*>(MAP_FAILED)};
+				size_t m_sqes_length{0};
+				unsigned* m_sq_tail{nullptr};
+				unsigned* m_sq_mask{nullptr};
+				unsigned* m_sq_array{nullptr};
+				unsigned* m_cq_head{nullptr};
+				unsigned* m_cq_tail{nullptr};
+				unsigned* m_cq_mask{nullptr};
+				io_uring_cqe* m_cqes{nullptr};
+			public:
+				explicit ring(unsigned entries) {
+					io_uring_params params{};
+					m_fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+					if(m_fd < 0) {
+						return;
+					}
+					m_sq_length = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+					m_cq_length = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+					m_sqes_length = params.sq_entries * sizeof(io_uring_sqe);
+					m_sq_ptr = mmap(nullptr, m_sq_length, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQ_RING);
+					m_cq_ptr = mmap(nullptr, m_cq_length, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_CQ_RING);
+					m_sqes = static_cast<io_uring_sqe*>(mmap(nullptr, m_sqes_length, PROT_READ | PROT_WRITE,
+								MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQES));
+					if(m_sq_ptr == MAP_FAILED || m_cq_ptr == MAP_FAILED || m_sqes == MAP_FAILED) {
+						release();
+						return;
+					}
+					char* sq = static_cast<char*>(m_sq_ptr);
+					char* cq = static_cast<char*>(m_cq_ptr);
+					m_sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+					m_sq_mask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+					m_sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+					m_cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+					m_cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+					m_cq_mask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+					m_cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+				}
+				~ring() {
+					release();
+				}
+				ring(const ring&) = delete;
+				ring& operator=(const ring&) = delete;
+				void release() {
+					if(m_sqes != MAP_FAILED) {
+						munmap(m_sqes, m_sqes_length);
+						m_sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+					}
+					if(m_cq_ptr != MAP_FAILED) {
+						munmap(m_cq_ptr, m_cq_length);
+						m_cq_ptr = MAP_FAILED;
+					}
+					if(m_sq_ptr != MAP_FAILED) {
+						munmap(m_sq_ptr, m_sq_length);
+						m_sq_ptr = MAP_FAILED;
+					}
+					if(m_fd >= 0) {
+						::close(m_fd);
+						m_fd = -1;
+					}
+				}
+				bool valid() const {
+					return m_fd >= 0;
+				}
+				/*
+				 * Checks whether the kernel supports the opcode. The kernels without the probe lack IORING_OP_READ too,
+				 * the rings of such kernels are set up anyway and fail every read by `-EINVAL`.
+				 */
+				bool supports(unsigned opcode) const {
+					constexpr unsigned ops_count = 256;
+					// the probe header is followed by an entry per opcode, the buffer of the entries keeps them aligned
+					constexpr size_t header_ops = (sizeof(io_uring_probe) + sizeof(io_uring_probe_op) - 1) / sizeof(io_uring_probe_op);
+					std::vector<io_uring_probe_op> buffer(header_ops + ops_count);
+					io_uring_probe* probe = reinterpret_cast<io_uring_probe*>(buffer.data());
+					if(syscall(__NR_io_uring_register, m_fd, IORING_REGISTER_PROBE, probe, ops_count) < 0) {
+						return false;
+					}
+					return opcode <= probe->last_op && (probe->ops[opcode].flags & IO_URING_OP_SUPPORTED) != 0;
+				}
+				/*
+				 * Queues a read, the number of the reads in flight never exceeds the number of the entries, so the ring is never full.
+				 */
+				void submit_read(int fd, char* buffer, unsigned length, size_t offset, uint64_t user_data) {
+					const unsigned tail = *m_sq_tail;
+					const unsigned index = tail & *m_sq_mask;
+					io_uring_sqe* sqe = &m_sqes[index];
+					std::memset(sqe, 0, sizeof(*sqe));
+					sqe->opcode = IORING_OP_READ;
+					sqe->fd = fd;
+					sqe->addr = reinterpret_cast<uint64_t>(buffer);
+					sqe->len = length;
+					sqe->off = offset;
+					sqe->user_data = user_data;
+					m_sq_array[index] = index;
+					__atomic_store_n(m_sq_tail, tail + 1, __ATOMIC_RELEASE);
+					while(syscall(__NR_io_uring_enter, m_fd, 1, 0, 0, nullptr, 0) < 0) {
+						if(errno != EINTR && errno != EAGAIN) {
+							throw libs::exception::custom_exception("Error: Can't submit the read to io_uring");
+						}
+					}
+				}
+				/*
+				 * Calls the function for every completion, blocks until there is at least one if `wait` is set.
+				 */
+				template <typename F>
+				void reap(bool wait, F&& fn) {
+					unsigned head = *m_cq_head;
+					if(wait && head == __atomic_load_n(m_cq_tail, __ATOMIC_ACQUIRE)) {
+						while(syscall(__NR_io_uring_enter, m_fd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0) {
+							if(errno != EINTR && errno != EAGAIN) {
+								throw libs::exception::custom_exception("Error: Can't wait for io_uring completions");
+							}
+						}
+					}
+					while(head != __atomic_load_n(m_cq_tail, __ATOMIC_ACQUIRE)) {
+						const io_uring_cqe& cqe = m_cqes[head & *m_cq_mask];
+						fn(cqe.user_data, cqe.res);
+						++head;
+						__atomic_store_n(m_cq_head, head, __ATOMIC_RELEASE);
+					}
+				}
+		};
+		std::unique_ptr<ring> m_ring{};
+#endif
+		int m_fd{-1};
+		size_t m_size{0};
+		size_t m_block_size{default_block_size};
+		bool m_direct{false};
+		async_backend m_backend{async_backend::pread};
+		std::vector<slot> m_slots{};
+		size_t m_blocks_count{0};
+		size_t m_next_block{0};
+		bool m_handed_out{false};
+		std::vector<std::thread> m_io_threads{};
+		std::mutex m_mtx;
+		std::condition_variable m_cnd;
+		bool m_stop{false};
+	private:
+		static size_t round_up(size_t value) {
+			return (value + alignment - 1) / alignment * alignment;
+		}
+		/*
+		 * Turns the direct I/O off, some file systems accept O_DIRECT by open and reject it by the first read.
+		 */
+		void drop_direct() {
+#if (defined(_UNIX_) || defined(__unix__)) && defined(O_DIRECT)
+			std::lock_guard<std::mutex> lck(m_mtx);
+			if(m_direct) {
+				const int flags = fcntl(m_fd, F_GETFL);
+				if(flags >= 0 && fcntl(m_fd, F_SETFL, flags & ~O_DIRECT) == 0) {
+					m_direct = false;
+				}
+			}
+#endif
+		}
+		/*
+		 * Accounts the result of a read, returns `true` once the slot is complete.
+		 * The direct reads ask for whole aligned blocks, the read of the last block is short by the end of the file.
+		 */
+		bool complete(slot& s, long result) {
+			if(result > 0) {
+				s.filled += result;
+				return s.filled >= s.length;
+			}
+			if(result == 0) {
+				// the file has been truncated since it was opened
+				s.length = s.filled;
+				return true;
+			}
+			if(result == -EINTR || result == -EAGAIN) {
+				return false;
+			}
+			if(result == -EINVAL && !s.retried) {
+				s.retried = true;
+				drop_direct();
+				return false;
+			}
+			s.error = static_cast<int>(-result);
+			return true;
+		}
+		void schedule(size_t slot_id, size_t block) {
+			{
+				std::lock_guard<std::mutex> lck(m_mtx);
+				slot& s = m_slots[slot_id];
+				s.offset = block * m_block_size;
+				s.length = std::min(m_block_size, m_size - s.offset);
+				s.filled = 0;
+				s.error = 0;
+				s.retried = false;
+				s.scheduled = true;
+				s.ready = false;
+			}
+#ifdef __ASYNC_FILE_READER_IO_URING__
+			if(m_ring) {
+				submit(slot_id);
+				return;
+			}
+#endif
+			m_cnd.notify_all();
+		}
+#ifdef __ASYNC_FILE_READER_IO_URING__
+		void submit(size_t slot_id) {
+			slot& s = m_slots[slot_id];
+			const size_t length = round_up(s.length) - s.filled;
+			m_ring.get()->submit_read(m_fd, s.buffer.get() + s.filled, static_cast<unsigned>(length), s.offset + s.filled, slot_id);
+		}
+#endif
+		/*
+		 * The loop of the helper thread which reads every block of its slot.
+		 */
+		void pread_loop(size_t slot_id) {
+#if defined(_UNIX_) || defined(__unix__)
+			slot& s = m_slots[slot_id];
+			while(true) {
+				{
+					std::unique_lock<std::mutex> lck(m_mtx);
+					m_cnd.wait(lck, [this, &s]{
+							return m_stop || (s.scheduled && !s.ready);
+							});
+					if(m_stop) {
+						return;
+					}
+				}
+				bool done = false;
+				while(!done) {
+					const size_t length = round_up(s.length) - s.filled;
+					const ssize_t result = ::pread(m_fd, s.buffer.get() + s.filled, length, s.offset + s.filled);
+					done = complete(s, result < 0 ? -errno : result);
+				}
+				{
+					std::lock_guard<std::mutex> lck(m_mtx);
+					s.ready = true;
+				}
+				m_cnd.notify_all();
+			}
+#endif
+		}
+		void wait_ready(size_t slot_id) {
+			slot& s = m_slots[slot_id];
+#ifdef __ASYNC_FILE_READER_IO_URING__
+			if(m_ring) {
+				while(!s.ready) {
+					m_ring.get()->reap(true, [this](uint64_t id, int result) {
+							slot& done = m_slots[id];
+							if(complete(done, result)) {
+								done.ready = true;
+							} else {
+								submit(id);
+							}
+							});
+				}
+				return;
+			}
+#endif
+			std::unique_lock<std::mutex> lck(m_mtx);
+			m_cnd.wait(lck, [&s]{
+					return s.ready;
+					});
+		}
+		void stop() {
+			{
+				std::lock_guard<std::mutex> lck(m_mtx);
+				m_stop = true;
+			}
+			m_cnd.notify_all();
+			for(auto& thread: m_io_threads) {
+				thread.join();
+			}
+			m_io_threads.clear();
+#ifdef __ASYNC_FILE_READER_IO_URING__
+			if(m_ring) {
+				// the kernel may still write into the buffers, so the reads in flight are drained first
+				try {
+					for(size_t i = 0; i < m_slots.size(); ++i) {
+						if(m_slots[i].scheduled) {
+							wait_ready(i);
+						}
+					}
+				} catch(...) {
+				}
+				m_ring.reset();
+			}
+#endif
+#if defined(_UNIX_) || defined(__unix__)
+			if(m_fd >= 0) {
+				::close(m_fd);
+				m_fd = -1;
+			}
+#endif
+		}
+	public:
+		/**
+		 * Constructor with arguments, opens the file and starts the first reads
+		 * \param file_path the path of the file
+		 * \param block_size the size of a single read, it is rounded up to the alignment
+		 * \param queue_depth the number of the buffers, i.e. the maximum number of the reads in flight
+		 * \param backend the preferred way to issue the reads, `pread` is used if io_uring isn't available
+		 * \param direct whether the page cache is bypassed if the file system allows it
+		 */
+		async_file_reader(const std::string& file_path,
+				size_t block_size = default_block_size,
+				size_t queue_depth = default_queue_depth,
+				async_backend backend = async_backend::io_uring,
+				bool direct = true):
+			m_block_size(round_up(std::max<size_t>(block_size, 1))) {
+#if defined(_UNIX_) || defined(__unix__)
+#ifdef O_DIRECT
+			if(direct) {
+				m_fd = ::open(file_path.c_str(), O_RDONLY | O_DIRECT);
+				m_direct = m_fd >= 0;
+			}
+#endif
+			if(m_fd < 0) {
+				m_fd = ::open(file_path.c_str(), O_RDONLY);
+			}
+			if(m_fd < 0) {
+				const std::string err_msg("Error: Can't open file: " + file_path);
+				throw libs::exception::custom_exception(err_msg.c_str());
+			}
+			struct stat st{};
+			if(fstat(m_fd, &st) != 0) {
+				::close(m_fd);
+				const std::string err_msg("Error: Can't stat file: " + file_path);
+				throw libs::exception::custom_exception(err_msg.c_str());
+			}
+			m_size = st.st_size;
+			m_blocks_count = (m_size + m_block_size - 1) / m_block_size;
+			m_slots.resize(std::max<size_t>(queue_depth, 1));
+			for(auto& s: m_slots) {
+				void* ptr = nullptr;
+				if(posix_memalign(&ptr, alignment, m_block_size) != 0) {
+					::close(m_fd);
+					throw libs::exception::custom_exception("Error: Can't allocate the read buffers");
+				}
+				s.buffer.reset(static_cast<char*>(ptr));
+			}
+#ifdef __ASYNC_FILE_READER_IO_URING__
+			if(backend == async_backend::io_uring) {
+				m_ring = std::make_unique<ring>(static_cast<unsigned>(m_slots.size()));
+				if(!m_ring.get()->valid() || !m_ring.get()->supports(IORING_OP_READ)) {
+					m_ring.reset();
+				} else {
+					m_backend = async_backend::io_uring;
+				}
+			}
+#endif
+			if(m_backend == async_backend::pread) {
+				for(size_t i = 0; i < m_slots.size(); ++i) {
+					m_io_threads.emplace_back(&async_file_reader::pread_loop, this, i);
+				}
+			}
+			for(size_t i = 0; i < std::min(m_slots.size(), m_blocks_count); ++i) {
+				schedule(i, i);
+			}
+#else
+			throw libs::exception::custom_exception("Error: Asynchronous input isn't supported on this platform");
+#endif
+		}
+		/**
+		 * Destructor waits for the reads in flight and closes the file
+		 */
+		~async_file_reader() {
+			stop();
+		}
+		async_file_reader(const async_file_reader&) = delete;
+		async_file_reader& operator=(const async_file_reader&) = delete;
+		/**
+		 * Gets the next block of the file in the file order, the buffer of the previous block is reused for a read ahead
+		 * @returns `std::optional<std::string_view>` which is valid until the next call, empty at the end of the file
+		 */
+		std::optional<std::string_view> next() {
+			if(m_handed_out) {
+				const size_t previous = m_next_block - 1;
+				m_handed_out = false;
+				if(previous + m_slots.size() < m_blocks_count) {
+					schedule(previous % m_slots.size(), previous + m_slots.size());
+				} else {
+					std::lock_guard<std::mutex> lck(m_mtx);
+					m_slots[previous % m_slots.size()].scheduled = false;
+				}
+			}
+			if(m_next_block >= m_blocks_count) {
+				return std::nullopt;
+			}
+			const size_t slot_id = m_next_block % m_slots.size();
+			wait_ready(slot_id);
+			const slot& s = m_slots[slot_id];
+			if(s.error != 0) {
+				const std::string err_msg("Error: Can't read the input file: " + std::string(std::strerror(s.error)));
+				throw libs::exception::custom_exception(err_msg.c_str());
+			}
+			++m_next_block;
+			m_handed_out = true;
+			if(s.filled < m_block_size) {
+				// the end of the file, possibly an earlier one if the file has been truncated
+				m_blocks_count = m_next_block;
+			}
+			return std::string_view(s.buffer.get(), std::min(s.filled, s.length));
+		}
+		/**
+		 * Gets the file size
+		 * @returns `size_t`
+		 */
+		size_t size() const {
+			return m_size;
+		}
+		/**
+		 * Gets the size of a single read
+		 * @returns `size_t`
+		 */
+		size_t block_size() const {
+			return m_block_size;
+		}
+		/**
+		 * Gets the way the reads are issued, it differs from the requested one if io_uring isn't available
+		 * @returns `async_backend`
+		 */
+		async_backend backend() const {
+			return m_backend;
+		}
+		/**
+		 * Checks whether the page cache is bypassed
+		 * @returns `bool`
+		 */
+		bool is_direct() const {
+			return m_direct;
+		}
+};
+}
+}
+
+#endif // __ASYNC_FILE_READER_HPP__
@@ -0,0 +1,92 @@
+#ifndef __CHECKPOINT_HPP__
+#define __CHECKPOINT_HPP__
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#if defined(_UNIX_) || defined(__unix__)
+#include <sys/stat.h>
+#endif
+
+#include "exception.hpp"
+
+namespace libs {
+	namespace proccesing {
+/**
+ * \brief Identifies an append-only input file across the runs: the device and the inode tell a rotated file apart,
+ * the hash of the first bytes tells apart a file which was truncated and written again in place.
+ */
+struct file_identity {
+	/// The number of the first bytes hashed at most
+	static constexpr size_t head_limit = 4096;
+	uint64_t device{0};
+	uint64_t inode{0};
+	uint64_t head_size{0};
+	uint64_t head_hash{0};
+	/**
+	 * Gets the identity of the file
+	 * \param path the path of the file
+	 * \param head_size the number of the first bytes to hash, fewer are hashed if the file is shorter
+	 * @returns `file_identity`
+	 */
+	static file_identity of(const std::string& path, size_t head_size) {
+		file_identity ret{};
+#if defined(_UNIX_) || defined(__unix__)
+		struct stat st{};
+		if(::stat(path.c_str(), &st) != 0) {
+			const std::string err_msg("Error: Can't stat file: " + path);
+			throw libs::exception::custom_exception(err_msg.c_str());
+		}
+		ret.device = st.st_dev;
+		ret.inode = st.st_ino;
+#endif
+		std::ifstream is(path, std::ios::binary);
+		std::vector<char> head(std::min(head_size, head_limit));
+		is.read(head.data(), head.size());
+		ret.head_size = is.gcount();
+		// FNV-1a, so the hash is the same whatever standard library wrote it
+		ret.head_hash = 14695981039346656037ULL;
+		for(size_t i = 0; i < ret.head_size; ++i) {
+			ret.head_hash = (ret.head_hash ^ static_cast<uint8_t>(head[i])) * 1099511628211ULL;
+		}
+		return ret;
+	}
+	bool operator==(const file_identity& other) const {
+		return device == other.device && inode == other.inode && head_size == other.head_size && head_hash == other.head_hash;
+	}
+	bool operator!=(const file_identity& other) const {
+		return !(*this == other);
+	}
+};
+/**
+ * Finds the end of the last complete line of the file, the line being appended is left for the next run
+ * \param path the path of the file
+ * \param first the offset the search stops at
+ * \param last the offset the search starts from, i.e. the size of the file seen by the run
+ * @returns `size_t` the offset just after the last line feed, or `first` if there is none after it
+ */
+inline size_t complete_lines_end(const std::string& path, size_t first, size_t last) {
+	std::ifstream is(path, std::ios::binary);
+	std::vector<char> buffer(64 * 1024);
+	while(last > first) {
+		const size_t count = std::min(buffer.size(), last - first);
+		is.seekg(last - count);
+		if(!is.read(buffer.data(), count)) {
+			throw libs::exception::custom_exception("Error: Unexpected end of the input file");
+		}
+		for(size_t i = count; i > 0; --i) {
+			if(buffer[i - 1] == '\n') {
+				return last - count + i;
+			}
+		}
+		last -= count;
+	}
+	return first;
+}
+}
+}
+
+#endif // __CHECKPOINT_HPP__
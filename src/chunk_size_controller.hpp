@@ -0,0 +1,131 @@
+#ifndef __CHUNK_SIZE_CONTROLLER_HPP__
+#define __CHUNK_SIZE_CONTROLLER_HPP__
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+
+namespace libs {
+	namespace proccesing {
+/**
+ * \brief Tunes the size of the chunks at runtime from the measured processing rate of the workers and the queue depth.
+ * The size approaches the amount of text a worker processes in the target time. It grows only while the queue is at least
+ * half full, i.e. the workers are the bottleneck and the per-chunk overhead matters. It may shrink anytime, so starving
+ * workers get smaller pieces sooner.
+ */
+class chunk_size_controller {
+	public:
+		/// The initial size, roughly the size of L2 cache
+		static constexpr size_t default_initial_size = 256 * 1024;
+		static constexpr size_t default_min_size = 4 * 1024;
+		static constexpr size_t default_max_size = 8 * 1024 * 1024;
+		static constexpr std::chrono::nanoseconds default_target_time = std::chrono::milliseconds(2);
+		/// The sizes are multiples of the alignment, except when the bounds say otherwise
+		static constexpr size_t alignment = 4 * 1024;
+	private:
+		size_t m_size{default_initial_size};
+		size_t m_min_size{default_min_size};
+		size_t m_max_size{default_max_size};
+		std::chrono::nanoseconds m_target_time{default_target_time};
+		size_t m_last_chunks{0};
+		size_t m_last_bytes{0};
+		std::chrono::nanoseconds m_last_busy{0};
+		size_t m_smallest{default_initial_size};
+		size_t m_largest{default_initial_size};
+		size_t m_adjustments{0};
+		mutable std::mutex m_mtx;
+	public:
+		/**
+		 * Constructor with arguments
+		 * \param initial_size the size used until the first measurement
+		 * \param min_size the lower bound of the size
+		 * \param max_size the upper bound of the size
+		 * \param target_time the processing time of a single chunk to aim for
+		 */
+		explicit chunk_size_controller(size_t initial_size = default_initial_size,
+				size_t min_size = default_min_size,
+				size_t max_size = default_max_size,
+				std::chrono::nanoseconds target_time = default_target_time):
+			m_min_size(std::max<size_t>(min_size, 1)),
+			m_max_size(std::max(max_size, std::max<size_t>(min_size, 1))),
+			m_target_time(target_time) {
+			m_size = std::clamp(initial_size, m_min_size, m_max_size);
+			m_smallest = m_largest = m_size;
+		}
+		chunk_size_controller(const chunk_size_controller&) = delete;
+		chunk_size_controller& operator=(const chunk_size_controller&) = delete;
+		/**
+		 * Gets the current size
+		 * @returns `size_t` the number of bytes
+		 */
+		size_t size() const {
+			std::lock_guard<std::mutex> lck(m_mtx);
+			return m_size;
+		}
+		/**
+		 * Updates the size from the workers' progress, may be called concurrently by several readers
+		 * \param chunks the total number of the processed chunks
+		 * \param bytes the total number of the processed bytes
+		 * \param busy_time the total time the workers spent processing the chunks
+		 * \param queue_depth the number of the chunks waiting in the queue
+		 * \param queue_capacity the maximum number of the waiting chunks
+		 * @returns `size_t` the size of the next chunk
+		 */
+		size_t update(size_t chunks, size_t bytes, std::chrono::nanoseconds busy_time, size_t queue_depth, size_t queue_capacity) {
+			std::lock_guard<std::mutex> lck(m_mtx);
+			if(chunks <= m_last_chunks || busy_time <= m_last_busy) {
+				return m_size;
+			}
+			const double rate = static_cast<double>(bytes - m_last_bytes) / (busy_time - m_last_busy).count();
+			m_last_chunks = chunks;
+			m_last_bytes = bytes;
+			m_last_busy = busy_time;
+			const double ideal = std::clamp(rate * m_target_time.count(),
+					static_cast<double>(m_min_size), static_cast<double>(m_max_size));
+			const bool workers_behind = queue_depth * 2 >= queue_capacity;
+			if(ideal > m_size && !workers_behind) {
+				return m_size;
+			}
+			// moves a quarter of the way, so a single noisy measurement doesn't swing the size
+			size_t next = static_cast<size_t>((3.0 * m_size + ideal) / 4.0);
+			if(next > alignment) {
+				next -= next % alignment;
+			}
+			next = std::clamp(next, m_min_size, m_max_size);
+			if(next != m_size) {
+				m_size = next;
+				++m_adjustments;
+				m_smallest = std::min(m_smallest, m_size);
+				m_largest = std::max(m_largest, m_size);
+			}
+			return m_size;
+		}
+		/**
+		 * Gets the smallest size chosen so far
+		 * @returns `size_t`
+		 */
+		size_t smallest() const {
+			std::lock_guard<std::mutex> lck(m_mtx);
+			return m_smallest;
+		}
+		/**
+		 * Gets the largest size chosen so far
+		 * @returns `size_t`
+		 */
+		size_t largest() const {
+			std::lock_guard<std::mutex> lck(m_mtx);
+			return m_largest;
+		}
+		/**
+		 * Gets the number of the changes of the size
+		 * @returns `size_t`
+		 */
+		size_t adjustments() const {
+			std::lock_guard<std::mutex> lck(m_mtx);
+			return m_adjustments;
+		}
+};
+}
+}
+
+#endif // __CHUNK_SIZE_CONTROLLER_HPP__
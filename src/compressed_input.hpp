@@ -0,0 +1,265 @@
+#ifndef __COMPRESSED_INPUT_HPP__
+#define __COMPRESSED_INPUT_HPP__
+
+#include <algorithm>
+#include <cstring>
+#include <istream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#if defined(_ZLIB_)
+#include <zlib.h>
+#endif
+#if defined(_ZSTD_)
+#include <zstd.h>
+#endif
+
+#include "exception.hpp"
+
+namespace libs {
+	namespace proccesing {
+/**
+ * @brief Defines the compression of the input
+ */
+enum class compression_type {
+	/// The plain text
+	none,
+	/// gzip, the concatenated members are decoded one by one
+	gzip,
+	/// Zstandard, the concatenated frames are decoded one by one
+	zstd
+};
+/**
+ * Detects the compression by the magic number at the beginning of the input
+ * \param data the first bytes of the input
+ * \param size the number of the bytes, at least 4 are needed to recognize any compression
+ * @returns `compression_type`
+ */
+inline compression_type detect_compression(const char* data, size_t size) {
+	const auto* bytes = reinterpret_cast<const unsigned char*>(data);
+	if(size >= 2 && bytes[0] == 0x1f && bytes[1] == 0x8b) {
+		return compression_type::gzip;
+	}
+	if(size >= 4 && bytes[0] == 0x28 && bytes[1] == 0xb5 && bytes[2] == 0x2f && bytes[3] == 0xfd) {
+		return compression_type::zstd;
+	}
+	return compression_type::none;
+}
+/**
+ * \brief Decodes the compressed input on the fly, the compression is detected by the magic number of the first bytes.
+ * The source is read forward only, so it may be a pipe as well. The plain input is passed through.
+ */
+class decoding_streambuf: public std::streambuf {
+	public:
+		/// The size of the compressed and the decoded buffers
+		static constexpr size_t default_buffer_size = 1 << 20;
+	private:
+		std::streambuf* m_source{nullptr};
+		std::vector<char> m_in{};
+		size_t m_in_pos{0};
+		size_t m_in_end{0};
+		bool m_source_eof{false};
+		std::vector<char> m_out{};
+		compression_type m_compression{compression_type::none};
+		bool m_detected{false};
+		bool m_finished{false};
+#if defined(_ZLIB_)
+		z_stream m_zstream{};
+		bool m_zstream_ready{false};
+#endif
+#if defined(_ZSTD_)
+		ZSTD_DCtx* m_zstd{nullptr};
+		size_t m_zstd_hint{0};
+#endif
+	private:
+		/*
+		 * Moves the unread input to the front of the buffer and reads the source till the buffer is full or the source ends.
+		 */
+		void fill_input() {
+			if(m_in_pos > 0) {
+				std::memmove(m_in.data(), m_in.data() + m_in_pos, m_in_end - m_in_pos);
+				m_in_end -= m_in_pos;
+				m_in_pos = 0;
+			}
+			while(!m_source_eof && m_in_end < m_in.size()) {
+				const std::streamsize got = m_source->sgetn(m_in.data() + m_in_end, m_in.size() - m_in_end);
+				if(got <= 0) {
+					m_source_eof = true;
+					break;
+				}
+				m_in_end += got;
+			}
+		}
+		void detect() {
+			while(!m_source_eof && m_in_end < 4) {
+				fill_input();
+			}
+			m_compression = detect_compression(m_in.data(), m_in_end);
+			m_detected = true;
+#if defined(_ZLIB_)
+			if(m_compression == compression_type::gzip) {
+				// 16 selects the gzip header and trailer
+				if(inflateInit2(&m_zstream, 16 + MAX_WBITS) != Z_OK) {
+					throw libs::exception::custom_exception("Error: Can't initialize gzip decoder");
+				}
+				m_zstream_ready = true;
+			}
+#else
+			if(m_compression == compression_type::gzip) {
+				throw libs::exception::custom_exception("Error: gzip input isn't supported by this build");
+			}
+#endif
+#if defined(_ZSTD_)
+			if(m_compression == compression_type::zstd) {
+				m_zstd = ZSTD_createDCtx();
+				if(m_zstd == nullptr) {
+					throw libs::exception::custom_exception("Error: Can't initialize zstd decoder");
+				}
+			}
+#else
+			if(m_compression == compression_type::zstd) {
+				throw libs::exception::custom_exception("Error: zstd input isn't supported by this build");
+			}
+#endif
+		}
+		size_t pass_through() {
+			if(m_in_pos == m_in_end) {
+				fill_input();
+			}
+			const size_t size = std::min(m_in_end - m_in_pos, m_out.size());
+			std::memcpy(m_out.data(), m_in.data() + m_in_pos, size);
+			m_in_pos += size;
+			m_finished = size == 0;
+			return size;
+		}
+#if defined(_ZLIB_)
+		size_t inflate_gzip() {
+			if(m_in_pos == m_in_end) {
+				fill_input();
+			}
+			m_zstream.next_in = reinterpret_cast<Bytef*>(m_in.data() + m_in_pos);
+			m_zstream.avail_in = static_cast<uInt>(m_in_end - m_in_pos);
+			m_zstream.next_out = reinterpret_cast<Bytef*>(m_out.data());
+			m_zstream.avail_out = static_cast<uInt>(m_out.size());
+			const int ret = inflate(&m_zstream, Z_NO_FLUSH);
+			m_in_pos = m_in_end - m_zstream.avail_in;
+			const size_t produced = m_out.size() - m_zstream.avail_out;
+			if(ret == Z_STREAM_END) {
+				if(m_in_pos == m_in_end) {
+					fill_input();
+				}
+				if(m_in_pos == m_in_end) {
+					m_finished = true;
+				} else {
+					// the next member of a concatenated input
+					inflateReset(&m_zstream);
+				}
+			} else if(ret == Z_BUF_ERROR || (ret == Z_OK && produced == 0)) {
+				if(m_source_eof && m_in_pos == m_in_end) {
+					throw libs::exception::custom_exception("Error: Truncated gzip input");
+				}
+			} else if(ret != Z_OK) {
+				throw libs::exception::custom_exception("Error: Corrupted gzip input");
+			}
+			return produced;
+		}
+#endif
+#if defined(_ZSTD_)
+		size_t decompress_zstd() {
+			if(m_in_pos == m_in_end) {
+				fill_input();
+			}
+			ZSTD_inBuffer in{m_in.data(), m_in_end, m_in_pos};
+			ZSTD_outBuffer out{m_out.data(), m_out.size(), 0};
+			const size_t ret = ZSTD_decompressStream(m_zstd, &out, &in);
+			if(ZSTD_isError(ret)) {
+				const std::string err_msg("Error: Corrupted zstd input: " + std::string(ZSTD_getErrorName(ret)));
+				throw libs::exception::custom_exception(err_msg.c_str());
+			}
+			m_in_pos = in.pos;
+			// `0` means the frame is complete, the input may continue with the next frame
+			m_zstd_hint = ret;
+			if(m_in_pos == m_in_end && out.pos < out.size) {
+				fill_input();
+				if(m_in_pos == m_in_end) {
+					if(m_zstd_hint != 0) {
+						throw libs::exception::custom_exception("Error: Truncated zstd input");
+					}
+					m_finished = true;
+				}
+			}
+			return out.pos;
+		}
+#endif
+	protected:
+		int_type underflow() override {
+			if(gptr() < egptr()) {
+				return traits_type::to_int_type(*gptr());
+			}
+			if(!m_detected) {
+				detect();
+			}
+			size_t produced = 0;
+			while(produced == 0 && !m_finished) {
+				switch(m_compression) {
+#if defined(_ZLIB_)
+					case compression_type::gzip:
+						produced = inflate_gzip();
+						break;
+#endif
+#if defined(_ZSTD_)
+					case compression_type::zstd:
+						produced = decompress_zstd();
+						break;
+#endif
+					default:
+						produced = pass_through();
+						break;
+				}
+			}
+			if(produced == 0) {
+				return traits_type::eof();
+			}
+			setg(m_out.data(), m_out.data(), m_out.data() + produced);
+			return traits_type::to_int_type(*gptr());
+		}
+	public:
+		/**
+		 * Constructor with arguments
+		 * \param source the buffer of the compressed input
+		 * \param buffer_size the size of the compressed and the decoded buffers
+		 */
+		explicit decoding_streambuf(std::streambuf* source, size_t buffer_size = default_buffer_size):
+			m_source(source),
+			m_in(std::max<size_t>(buffer_size, 4)),
+			m_out(std::max<size_t>(buffer_size, 1)) {
+			setg(m_out.data(), m_out.data(), m_out.data());
+		}
+		/**
+		 * Destructor releases the decoder
+		 */
+		~decoding_streambuf() override {
+#if defined(_ZLIB_)
+			if(m_zstream_ready) {
+				inflateEnd(&m_zstream);
+			}
+#endif
+#if defined(_ZSTD_)
+			ZSTD_freeDCtx(m_zstd);
+#endif
+		}
+		decoding_streambuf(const decoding_streambuf&) = delete;
+		decoding_streambuf& operator=(const decoding_streambuf&) = delete;
+		/**
+		 * Gets the compression of the input, it is known once the first byte is read
+		 * @returns `compression_type`
+		 */
+		compression_type compression() const {
+			return m_compression;
+		}
+};
+}
+}
+
+#endif // __COMPRESSED_INPUT_HPP__
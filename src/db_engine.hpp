@@ -7,17 +7,141 @@
 #include <sqlite3.h>
 #include <stdio.h>
 #include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
 
 #include "exception.hpp"
 
 namespace libs {
 	namespace db {
+		/**
+		 * Wraps up a native prepared statement, so the sql is parsed once and executed many times with different bound values
+		 */
+class statement {
+	private:
+		sqlite3* m_db{nullptr};
+		sqlite3_stmt* m_stmt{nullptr};
+		void check(int status, const char* what) const {
+			if(status != SQLITE_OK) {
+				const std::string err_msg(std::string("Error: Can't ") + what + ", " + sqlite3_errmsg(m_db));
+				throw libs::exception::custom_exception(err_msg.c_str());
+			}
+		}
+	public:
+		/**
+		 * Constructor with arguments, compiles the sql
+		 * \param db the native db connection
+		 * \param sql the sql command with `?` placeholders
+		 */
+		statement(sqlite3* db, const std::string& sql): m_db(db) {
+			if(sqlite3_prepare_v2(m_db, sql.c_str(), -1, &m_stmt, nullptr) != SQLITE_OK) {
+				const std::string err_msg("Error: Can't prepare command: " + sql + ", " + sqlite3_errmsg(m_db));
+				throw libs::exception::custom_exception(err_msg.c_str());
+			}
+		}
+		/**
+		 * Destructor finalizes the statement
+		 */
+		~statement() {
+			sqlite3_finalize(m_stmt);
+		}
+		statement(const statement&) = delete;
+		statement& operator=(const statement&) = delete;
+		/**
+		 * Binds the text value
+		 * \param idx the 1-based index of the placeholder
+		 * \param value the value, it is copied by sqlite
+		 * @returns `statement&`
+		 */
+		statement& bind(int idx, std::string_view value) {
+			check(sqlite3_bind_text(m_stmt, idx, value.data(), value.size(), SQLITE_TRANSIENT), "bind text");
+			return *this;
+		}
+		/**
+		 * Binds the binary value
+		 * \param idx the 1-based index of the placeholder
+		 * \param value the bytes, they are copied by sqlite
+		 * @returns `statement&`
+		 */
+		statement& bind_blob(int idx, std::string_view value) {
+			check(sqlite3_bind_blob(m_stmt, idx, value.data(), value.size(), SQLITE_TRANSIENT), "bind blob");
+			return *this;
+		}
+		/**
+		 * Binds the integer value
+		 * \param idx the 1-based index of the placeholder
+		 * \param value the value
+		 * @returns `statement&`
+		 */
+		statement& bind(int idx, sqlite3_int64 value) {
+			check(sqlite3_bind_int64(m_stmt, idx, value), "bind integer");
+			return *this;
+		}
+		/**
+		 * Executes the statement for a single step
+		 * @returns `bool` which indicates whether a row is available
+		 */
+		bool step() {
+			const int status = sqlite3_step(m_stmt);
+			if(status == SQLITE_ROW) {
+				return true;
+			}
+			if(status != SQLITE_DONE) {
+				const std::string err_msg(std::string("Error: Can't execute statement: ") + sqlite3_sql(m_stmt) + ", " + sqlite3_errmsg(m_db));
+				throw libs::exception::custom_exception(err_msg.c_str());
+			}
+			return false;
+		}
+		/**
+		 * Executes the statement which doesn't return rows and resets it, so it can be bound and executed again
+		 * @returns `void`
+		 */
+		void execute() {
+			step();
+			reset();
+		}
+		/**
+		 * Resets the statement and clears the bindings
+		 * @returns `void`
+		 */
+		void reset() {
+			sqlite3_reset(m_stmt);
+			sqlite3_clear_bindings(m_stmt);
+		}
+		/**
+		 * Gets the text value of the current row
+		 * \param col the 0-based column index
+		 * @returns `std::string`
+		 */
+		std::string column_text(int col) const {
+			const unsigned char* text = sqlite3_column_text(m_stmt, col);
+			return text == nullptr ? std::string() : std::string(reinterpret_cast<const char*>(text), sqlite3_column_bytes(m_stmt, col));
+		}
+		/**
+		 * Gets the binary value of the current row
+		 * \param col the 0-based column index
+		 * @returns `std::string_view` which is valid until the next step or reset of the statement
+		 */
+		std::string_view column_blob(int col) const {
+			const void* blob = sqlite3_column_blob(m_stmt, col);
+			return blob == nullptr ? std::string_view() : std::string_view(static_cast<const char*>(blob), sqlite3_column_bytes(m_stmt, col));
+		}
+		/**
+		 * Gets the integer value of the current row
+		 * \param col the 0-based column index
+		 * @returns `sqlite3_int64`
+		 */
+		sqlite3_int64 column_int(int col) const {
+			return sqlite3_column_int64(m_stmt, col);
+		}
+};
 		/**
 		 * Wraps up native db queries, by this providing an high level interface sql interaction interface
 		 */
 class db_engine {
 	private:
-		sqlite3* m_db;
+		sqlite3* m_db{nullptr};
 		mutable std::string m_db_name{};
 		int m_status{INT_MIN};
 		using key_val_pair = std::pair<std::string, std::string>;
@@ -89,6 +213,47 @@ class db_engine {
 			}
 			return 0;
 		}
+		/**
+		 * Compiles the sql command into a prepared statement
+		 * \param cmd the sql command with `?` placeholders
+		 * @returns `std::unique_ptr<statement>`
+		 */
+		std::unique_ptr<statement> prepare(const std::string& cmd) {
+			return std::make_unique<statement>(m_db, cmd);
+		}
+		/**
+		 * Starts an explicit transaction, so the following commands are written to the disk at once
+		 * @returns `void`
+		 */
+		void begin_transaction() {
+			execute_command("BEGIN TRANSACTION;");
+		}
+		/**
+		 * Commits the explicit transaction
+		 * @returns `void`
+		 */
+		void commit() {
+			execute_command("COMMIT;");
+		}
+		/**
+		 * Rollbacks the explicit transaction
+		 * @returns `void`
+		 */
+		void rollback() {
+			execute_command("ROLLBACK;");
+		}
+		/**
+		 * Tunes the connection for the bulk writes: write-ahead log, relaxed syncing and in-memory temporary storage
+		 * \param cache_size_kib the page cache size in KiB
+		 * @returns `void`
+		 */
+		void tune_for_bulk_writes(size_t cache_size_kib = 64 * 1024) {
+			execute_command("PRAGMA journal_mode=WAL;");
+			execute_command("PRAGMA synchronous=NORMAL;");
+			execute_command("PRAGMA temp_store=MEMORY;");
+			execute_command("PRAGMA cache_size=-" + std::to_string(cache_size_kib) + ";");
+			clear_last_result();
+		}
 		/**
 		 * Closes the db connection
 		 * @returns `void`
@@ -97,6 +262,7 @@ class db_engine {
 			if(m_db) {
 				try {
 					sqlite3_close(m_db);
+					m_db = nullptr;
 				} catch (std::exception& exp) {
 					std::cout << "Error: can't close db connection" << exp.what() << "\n";
 				}
@@ -0,0 +1,98 @@
+#ifndef __FILE_WATCHER_HPP__
+#define __FILE_WATCHER_HPP__
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+#if defined(__linux__) && __has_include(<sys/inotify.h>)
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#define __FILE_WATCHER_INOTIFY__
+#endif
+
+namespace libs {
+	namespace proccesing {
+/**
+ * \brief Waits for the changes of a file: inotify wakes the caller as soon as the file is written on Linux,
+ * elsewhere or if inotify isn't available the caller just sleeps for the timeout and polls the file.
+ */
+class file_watcher {
+	private:
+		std::string m_path{};
+		int m_fd{-1};
+		int m_wd{-1};
+	public:
+		/**
+		 * Constructor with an argument, starts watching the file
+		 * \param path the path of the file
+		 */
+		explicit file_watcher(const std::string& path): m_path(path) {
+#ifdef __FILE_WATCHER_INOTIFY__
+			m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+			rewatch();
+		}
+		/**
+		 * Destructor stops watching the file
+		 */
+		~file_watcher() {
+#ifdef __FILE_WATCHER_INOTIFY__
+			if(m_fd >= 0) {
+				::close(m_fd);
+			}
+#endif
+		}
+		file_watcher(const file_watcher&) = delete;
+		file_watcher& operator=(const file_watcher&) = delete;
+		/**
+		 * Watches the file found at the path now, e.g. the new file once the previous one has been rotated
+		 * @returns `void`
+		 */
+		void rewatch() {
+#ifdef __FILE_WATCHER_INOTIFY__
+			if(m_fd < 0) {
+				return;
+			}
+			if(m_wd >= 0) {
+				inotify_rm_watch(m_fd, m_wd);
+			}
+			// the file may not exist for a moment while it is rotated, the polling covers it until then
+			m_wd = inotify_add_watch(m_fd, m_path.c_str(), IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE | IN_MOVE_SELF | IN_DELETE_SELF);
+#endif
+		}
+		/**
+		 * Waits until the file changes or the timeout expires
+		 * \param timeout the longest wait
+		 * @returns `bool` which indicates whether a change has been notified
+		 */
+		bool wait(std::chrono::milliseconds timeout) {
+#ifdef __FILE_WATCHER_INOTIFY__
+			if(m_wd >= 0) {
+				pollfd fds{m_fd, POLLIN, 0};
+				if(::poll(&fds, 1, static_cast<int>(timeout.count())) <= 0) {
+					return false;
+				}
+				// the events only wake the caller which checks the file itself
+				alignas(inotify_event) char events[4096];
+				while(::read(m_fd, events, sizeof(events)) > 0) {
+				}
+				return true;
+			}
+#endif
+			std::this_thread::sleep_for(timeout);
+			return false;
+		}
+		/**
+		 * Checks whether the changes are notified, otherwise the file is polled
+		 * @returns `bool`
+		 */
+		bool is_notified() const {
+			return m_wd >= 0;
+		}
+};
+}
+}
+
+#endif // __FILE_WATCHER_HPP__
@@ -0,0 +1,446 @@
+#ifndef __FLAT_COUNTER_HPP__
+#define __FLAT_COUNTER_HPP__
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace libs {
+	namespace datastructure {
+
+/**
+ * \brief Bump allocator which keeps the interned keys, the memory is released all at once.
+ */
+class string_arena {
+	private:
+		static constexpr size_t min_block_size = 64 * 1024;
+		std::vector<std::unique_ptr<char[]>> m_blocks{};
+		char* m_cursor{nullptr};
+		size_t m_left{0};
+		size_t m_allocated{0};
+	public:
+		string_arena() = default;
+		string_arena(string_arena&&) = default;
+		string_arena& operator=(string_arena&&) = default;
+		string_arena(const string_arena&) = delete;
+		string_arena& operator=(const string_arena&) = delete;
+		/**
+		 * Copies the string into the arena
+		 * \param str the string to intern
+		 * @returns `std::string_view` which stays valid until the arena is cleared or destroyed
+		 */
+		std::string_view intern(std::string_view str) {
+			if(str.empty()) {
+				return std::string_view("", 0);
+			}
+			if(str.size() > m_left) {
+				const size_t block_size = std::max(min_block_size, str.size());
+				m_blocks.emplace_back(new char[block_size]);
+				m_cursor = m_blocks.back().get();
+				m_left = block_size;
+				m_allocated += block_size;
+			}
+			char* dest = m_cursor;
+			std::memcpy(dest, str.data(), str.size());
+			m_cursor += str.size();
+			m_left -= str.size();
+			return std::string_view(dest, str.size());
+		}
+		/**
+		 * Releases all the interned strings
+		 * @returns `void`
+		 */
+		void clear() {
+			m_blocks.clear();
+			m_cursor = nullptr;
+			m_left = 0;
+			m_allocated = 0;
+		}
+		/**
+		 * Gets the number of bytes allocated by the arena
+		 * @returns `size_t`
+		 */
+		size_t memory_usage() const {
+			return m_allocated;
+		}
+};
+
+/**
+ * \brief Open addressing hash table which maps strings to counters.
+ * Uses linear probing with Robin Hood displacement, keeps the hash of every key in its slot
+ * and interns the keys into a bump arena, so there is no per-entry heap allocation.
+ * \tparam T the key type the entries are converted to, e.g. `std::string`
+ * \tparam U the counter type
+ */
+template <typename T, typename U>
+class flat_counter {
+	private:
+		struct slot {
+			const char* key{nullptr};
+			size_t length{0};
+			size_t hash{0};
+			U value{};
+		};
+		static constexpr size_t min_capacity = 16;
+		/// The minimal number of the slots scanned by a separate thread looking for the top entries
+		static constexpr size_t min_shard_slots = 1 << 16;
+		/// The table grows when it is filled more than max_load_numerator / max_load_denominator
+		static constexpr size_t max_load_numerator = 7;
+		static constexpr size_t max_load_denominator = 8;
+		std::vector<slot> m_slots{};
+		size_t m_size{0};
+		string_arena m_arena{};
+	public:
+		using hasher = std::hash<std::string_view>;
+		/**
+		 * \brief Forward iterator over the entries, dereferences to a pair of the key and the counter
+		 */
+		class const_iterator {
+			private:
+				const slot* m_cur{nullptr};
+				const slot* m_end{nullptr};
+				void skip_empty() {
+					while(m_cur != m_end && m_cur->key == nullptr) {
+						++m_cur;
+					}
+				}
+			public:
+				using value_type = std::pair<std::string_view, U>;
+				const_iterator(const slot* cur, const slot* end): m_cur(cur), m_end(end) {
+					skip_empty();
+				}
+				value_type operator*() const {
+					return value_type(std::string_view(m_cur->key, m_cur->length), m_cur->value);
+				}
+				const_iterator& operator++() {
+					++m_cur;
+					skip_empty();
+					return *this;
+				}
+				bool operator==(const const_iterator& other) const {
+					return m_cur == other.m_cur;
+				}
+				bool operator!=(const const_iterator& other) const {
+					return m_cur != other.m_cur;
+				}
+		};
+	private:
+		static bool matches(const slot& s, std::string_view key, size_t hash) {
+			return s.hash == hash && s.length == key.size() &&
+				(key.empty() || std::memcmp(s.key, key.data(), key.size()) == 0);
+		}
+		static size_t hash_of(std::string_view key) {
+			return hasher{}(key);
+		}
+		/*
+		 * The order of the top entries: the greater counter first, the equal counters by the key.
+		 */
+		static bool ranks_before(const std::pair<std::string_view, U>& lhs, const std::pair<std::string_view, U>& rhs) {
+			return lhs.second != rhs.second ? lhs.second > rhs.second : lhs.first < rhs.first;
+		}
+		/*
+		 * Keeps n best entries of the slots range in a heap which top is the worst candidate.
+		 */
+		void select_top(size_t first, size_t last, size_t n, std::vector<std::pair<std::string_view, U>>& heap) const {
+			heap.reserve(n);
+			for(size_t i = first; i < last; ++i) {
+				const slot& s = m_slots[i];
+				if(s.key == nullptr) {
+					continue;
+				}
+				std::pair<std::string_view, U> entry(std::string_view(s.key, s.length), s.value);
+				if(heap.size() < n) {
+					heap.push_back(entry);
+					std::push_heap(heap.begin(), heap.end(), ranks_before);
+				} else if(ranks_before(entry, heap.front())) {
+					std::pop_heap(heap.begin(), heap.end(), ranks_before);
+					heap.back() = entry;
+					std::push_heap(heap.begin(), heap.end(), ranks_before);
+				}
+			}
+		}
+		void grow() {
+			std::vector<slot> old(std::max(min_capacity, m_slots.size() * 2));
+			old.swap(m_slots);
+			for(slot& s: old) {
+				if(s.key != nullptr) {
+					place(s);
+				}
+			}
+		}
+		/*
+		 * Places the slot of a key which isn't in the table, returns the index it landed on
+		 */
+		size_t place(slot entry) {
+			const size_t mask = m_slots.size() - 1;
+			size_t idx = entry.hash & mask;
+			size_t dist = 0;
+			size_t landed = m_slots.size();
+			while(true) {
+				slot& s = m_slots[idx];
+				if(s.key == nullptr) {
+					s = entry;
+					return landed == m_slots.size() ? idx : landed;
+				}
+				const size_t s_dist = (idx - (s.hash & mask)) & mask;
+				if(s_dist < dist) {
+					std::swap(s, entry);
+					if(landed == m_slots.size()) {
+						landed = idx;
+					}
+					dist = s_dist;
+				}
+				idx = (idx + 1) & mask;
+				++dist;
+			}
+		}
+		slot* lookup(std::string_view key, size_t hash) const {
+			if(m_slots.empty()) {
+				return nullptr;
+			}
+			const size_t mask = m_slots.size() - 1;
+			size_t idx = hash & mask;
+			for(size_t dist = 0; ; ++dist) {
+				const slot& s = m_slots[idx];
+				if(s.key == nullptr || ((idx - (s.hash & mask)) & mask) < dist) {
+					return nullptr;
+				}
+				if(matches(s, key, hash)) {
+					return const_cast<slot*>(&s);
+				}
+				idx = (idx + 1) & mask;
+			}
+		}
+	public:
+		/**
+		 * Constructor with an argument
+		 * \param capacity_hint the expected number of the distinct keys
+		 */
+		explicit flat_counter(size_t capacity_hint = 0) {
+			reserve(capacity_hint);
+		}
+		/**
+		 * The move constructor, leaves the other table empty
+		 */
+		flat_counter(flat_counter&& other): 
+			m_slots(std::move(other.m_slots)), 
+			m_size(std::exchange(other.m_size, 0)), 
+			m_arena(std::move(other.m_arena)) {
+			other.clear();
+		}
+		/**
+		 * The move assignement operator, leaves the other table empty
+		 */
+		flat_counter& operator=(flat_counter&& other) {
+			if(this != &other) {
+				m_slots = std::move(other.m_slots);
+				m_size = std::exchange(other.m_size, 0);
+				m_arena = std::move(other.m_arena);
+				other.clear();
+			}
+			return *this;
+		}
+		flat_counter(const flat_counter&) = delete;
+		flat_counter& operator=(const flat_counter&) = delete;
+		/**
+		 * Prepares the table for the given number of keys without the further rehashing
+		 * \param count the expected number of the distinct keys
+		 * @returns `void`
+		 */
+		void reserve(size_t count) {
+			if(count == 0 && m_slots.empty()) {
+				return;
+			}
+			size_t capacity = std::max(min_capacity, m_slots.size());
+			while(count * max_load_denominator > capacity * max_load_numerator) {
+				capacity *= 2;
+			}
+			if(capacity != m_slots.size()) {
+				std::vector<slot> old(capacity);
+				old.swap(m_slots);
+				for(slot& s: old) {
+					if(s.key != nullptr) {
+						place(s);
+					}
+				}
+			}
+		}
+		/**
+		 * Adds the value to the key's counter, inserts the key if it isn't in the table
+		 * \param key the key
+		 * \param hash the key hash, must be equal to `hash_function()(key)`
+		 * \param value the value to add
+		 * @returns `U&` the key's counter
+		 */
+		U& add(std::string_view key, size_t hash, U value) {
+			if(slot* s = lookup(key, hash)) {
+				s->value += value;
+				return s->value;
+			}
+			if((m_size + 1) * max_load_denominator > m_slots.size() * max_load_numerator) {
+				grow();
+			}
+			std::string_view interned = m_arena.intern(key);
+			slot entry{interned.data(), interned.size(), hash, value};
+			++m_size;
+			return m_slots[place(entry)].value;
+		}
+		/**
+		 * Adds the value to the key's counter, inserts the key if it isn't in the table
+		 * \param key the key
+		 * \param value the value to add
+		 * @returns `U&` the key's counter
+		 */
+		U& add(std::string_view key, U value) {
+			return add(key, hash_of(key), value);
+		}
+		/**
+		 * Gets the key's counter, inserts the key with zero counter if it isn't in the table
+		 * \param key the key
+		 * @returns `U&`
+		 */
+		U& operator[](std::string_view key) {
+			return add(key, U{});
+		}
+		/**
+		 * Finds the key's counter
+		 * \param key the key
+		 * @returns `const U*` or `nullptr` if there is no such key
+		 */
+		const U* find(std::string_view key) const {
+			const slot* s = lookup(key, hash_of(key));
+			return s == nullptr ? nullptr : &s->value;
+		}
+		/**
+		 * Adds all the counters of the other table
+		 * \param other the table to merge
+		 * @returns `void`
+		 */
+		void merge(const flat_counter& other) {
+			reserve(m_size + other.m_size);
+			for(const slot& s: other.m_slots) {
+				if(s.key != nullptr) {
+					add(std::string_view(s.key, s.length), s.hash, s.value);
+				}
+			}
+		}
+		/**
+		 * Calls the function for every entry
+		 * \param fn the callable taking the key as `std::string_view`, the key hash and the counter
+		 * @returns `void`
+		 */
+		template <typename F>
+		void for_each_hashed(F&& fn) const {
+			for(const slot& s: m_slots) {
+				if(s.key != nullptr) {
+					fn(std::string_view(s.key, s.length), s.hash, s.value);
+				}
+			}
+		}
+		/**
+		 * Gets n entries with the greatest counters, the keys of the equal counters are ordered alphabetically.
+		 * The slots are split into ranges scanned by separate threads and every range keeps at most n candidates,
+		 * so the extra memory is O(n) per range whatever the table size is.
+		 * \param n the number of the entries
+		 * \param shards the number of the threads scanning the table
+		 * @returns `std::vector<std::pair<std::string_view, U>>` ordered by the counter descending, the keys refer to the table
+		 */
+		std::vector<std::pair<std::string_view, U>> top_n(size_t n, size_t shards = 1) const {
+			std::vector<std::pair<std::string_view, U>> ret{};
+			if(n == 0 || m_size == 0) {
+				return ret;
+			}
+			n = std::min(n, m_size);
+			shards = std::clamp<size_t>(shards, 1, std::max<size_t>(m_slots.size() / min_shard_slots, 1));
+			if(shards == 1) {
+				select_top(0, m_slots.size(), n, ret);
+			} else {
+				std::vector<std::vector<std::pair<std::string_view, U>>> heaps(shards);
+				std::vector<std::thread> threads{};
+				const size_t range = (m_slots.size() + shards - 1) / shards;
+				for(size_t i = 0; i < shards; ++i) {
+					const size_t first = std::min(i * range, m_slots.size());
+					const size_t last = std::min(first + range, m_slots.size());
+					threads.emplace_back([this, first, last, n, &heaps, i]() {
+							select_top(first, last, n, heaps[i]);
+							});
+				}
+				for(auto& thread: threads) {
+					thread.join();
+				}
+				for(auto& heap: heaps) {
+					ret.insert(ret.end(), heap.begin(), heap.end());
+				}
+			}
+			std::partial_sort(ret.begin(), ret.begin() + n, ret.end(), ranks_before);
+			ret.resize(n);
+			return ret;
+		}
+		/**
+		 * Gets the number of the keys
+		 * @returns `size_t`
+		 */
+		size_t size() const {
+			return m_size;
+		}
+		/**
+		 * Checks whether the table is empty
+		 * @returns `bool`
+		 */
+		bool empty() const {
+			return m_size == 0;
+		}
+		/**
+		 * Removes all the entries and releases the memory
+		 * @returns `void`
+		 */
+		void clear() {
+			std::vector<slot>().swap(m_slots);
+			m_arena.clear();
+			m_size = 0;
+		}
+		/**
+		 * Gets the approximate memory footprint of the table
+		 * @returns `size_t` the number of bytes
+		 */
+		size_t memory_usage() const {
+			return m_slots.capacity() * sizeof(slot) + m_arena.memory_usage();
+		}
+		/**
+		 * Gets the hash function
+		 * @returns `hasher`
+		 */
+		hasher hash_function() const {
+			return hasher{};
+		}
+		const_iterator begin() const {
+			return const_iterator(m_slots.data(), m_slots.data() + m_slots.size());
+		}
+		const_iterator end() const {
+			return const_iterator(m_slots.data() + m_slots.size(), m_slots.data() + m_slots.size());
+		}
+		/**
+		 * Converts the table to a node based hash map
+		 * @returns `std::unordered_map<T, U>`
+		 */
+		std::unordered_map<T, U> to_map() const {
+			std::unordered_map<T, U> ret{};
+			ret.reserve(m_size);
+			for(const slot& s: m_slots) {
+				if(s.key != nullptr) {
+					ret.emplace(T(s.key, s.length), s.value);
+				}
+			}
+			return ret;
+		}
+};
+}
+}
+
+#endif // __FLAT_COUNTER_HPP__
@@ -0,0 +1,70 @@
+#ifndef __INPUT_PATHS_HPP__
+#define __INPUT_PATHS_HPP__
+
+#include <algorithm>
+#include <filesystem>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#if defined(_UNIX_) || defined(__unix__)
+#include <fnmatch.h>
+#endif
+
+#include "exception.hpp"
+
+namespace libs {
+
+namespace utils {
+	/// The positions of several input files are kept apart by the file index above these bits, i.e. up to 1 TiB per file
+	constexpr size_t input_offset_bits = 40;
+	/**
+	 * Checks whether the path has the wildcards of a glob pattern
+	 * \param path the path
+	 * @returns `bool`
+	 */
+	inline bool is_glob_pattern(const std::string& path) {
+		return path.find_first_of("*?[") != std::string::npos;
+	}
+	/**
+	 * Expands the input arguments into the list of the files: a directory stands for its regular files,
+	 * a glob pattern in the file name, e.g. `logs/2022-*.log`, for the matching files of its directory.
+	 * The files of a directory or a pattern are sorted by the name, the other paths are kept as they are.
+	 * \param args the files, the directories and the patterns
+	 * @returns `std::vector<std::string>`
+	 */
+	inline std::vector<std::string> expand_input_paths(const std::vector<std::string>& args) {
+		std::vector<std::string> ret{};
+		for(const std::string& arg: args) {
+			std::error_code ec;
+			const bool directory = std::filesystem::is_directory(arg, ec);
+			if(!directory && !is_glob_pattern(arg)) {
+				ret.push_back(arg);
+				continue;
+			}
+			const std::filesystem::path path(arg);
+			const std::filesystem::path dir = directory ? path : (path.has_parent_path() ? path.parent_path() : ".");
+			const std::string pattern = directory ? "*" : path.filename().string();
+#if defined(_UNIX_) || defined(__unix__)
+			std::vector<std::string> matches{};
+			for(const auto& entry: std::filesystem::directory_iterator(dir, ec)) {
+				if(entry.is_regular_file(ec) && fnmatch(pattern.c_str(), entry.path().filename().c_str(), 0) == 0) {
+					matches.push_back(entry.path().string());
+				}
+			}
+			if(ec) {
+				const std::string err_msg("Error: Can't list directory: " + dir.string());
+				throw libs::exception::custom_exception(err_msg.c_str());
+			}
+			std::sort(matches.begin(), matches.end());
+			ret.insert(ret.end(), matches.begin(), matches.end());
+#else
+			throw libs::exception::custom_exception("Error: Directories and patterns aren't supported on this platform");
+#endif
+		}
+		return ret;
+	}
+}
+}
+
+#endif // __INPUT_PATHS_HPP__
@@ -1,16 +1,39 @@
 #ifndef __IO_ENGINE__
 #define __IO_ENGINE__
 
+#include <algorithm>
+#include <chrono>
+#include <exception>
 #include <filesystem>
 #include <fstream>
+#include <atomic>
 #include <functional>
+#include <iostream>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
 #include <vector>
 
 #include "analyze_stats_engine.hpp"
+#include "async_file_reader.hpp"
+#include "checkpoint.hpp"
+#include "chunk_size_controller.hpp"
+#include "compressed_input.hpp"
 #include "db_engine.hpp"
 #include "exception.hpp"
-#include "task_queue.hpp"
+#include "file_watcher.hpp"
+#include "input_paths.hpp"
+#include "mapped_file.hpp"
+#include "pipeline_profile.hpp"
+#include "position_list.hpp"
+#include "ring_buffer.hpp"
+#include "snapshot.hpp"
+#include "spill_aggregator.hpp"
+#include "text_span.hpp"
+#include "top_n_tracker.hpp"
 
 
  /// file: io_engine.hpp
@@ -18,6 +41,21 @@
 
 namespace libs {
 	namespace proccesing {
+/**
+ * @brief Defines the way the input file is read
+ */
+enum class reader_type {
+	/// `std::ifstream` reads every chunk into a buffer
+	stream,
+	/// The file is memory mapped and the chunks are passed to the workers as views into the mapping
+	mapped,
+	/// The file is split into byte ranges at the spaces, every range is read by its own thread
+	parallel,
+	/// Several aligned reads are kept in flight by io_uring or by the `pread` threads, bypassing the page cache if possible
+	async,
+	/// The input is read forward only, so it may be the standard input, a pipe or a socket. The other readers fall back to it for such inputs and for the compressed ones
+	forward
+};
 /**
  * @brief Defines the main engine which is responsible for files, DB-queries and task distributions.
  * \tparam T the type of data stored in the map as a key
@@ -26,16 +64,163 @@ namespace libs {
 template <typename T, typename U>
 class io_engine {
 	private:
-		using callback = std::function<void(void)>;
 		using callback2 = std::function<T(size_t)>;
-		void handler(std::tuple<T, U, U>&& tuple, callback&& cb) {
-			if(m_queue) {
-				m_queue.get()->push(std::move(tuple));
+		using queue_type = typename libs::analysis::analyze_stats_engine<T, U>::queue_type;
+		using counter_type = typename libs::analysis::analyze_stats_engine<T, U>::counter_type;
+		using smileys_map = typename libs::analysis::analyze_stats_engine<T, U>::smileys_map;
+		void handler(libs::analysis::analyze_stats_engine<T, U>& stats, std::tuple<T, U, U>&& tuple) {
+			stats.submit(std::move(tuple));
+		}
+		/*
+		 * A chunk counted ahead of the chunks before it, it waits for them so a batch always ends a contiguous prefix of the input.
+		 */
+		struct early_chunk {
+			size_t end{0};
+			counter_type word_freq{};
+			smileys_map smileys{};
+		};
+		void add_pending(const counter_type& word_freq, const smileys_map& smileys) {
+			m_pending_word_freq.merge(word_freq);
+			for(const auto& [code, positions]: smileys) {
+				m_pending_smileys[code].append(positions);
+			}
+			++m_pending_chunks;
+		}
+		void store_chunk(const counter_type& local_word_freq, const smileys_map& local_smileys, size_t end, size_t length) {
+			counter_type batch_word_freq{};
+			smileys_map batch_smileys{};
+			size_t batch_end = 0;
+			std::unique_lock<std::mutex> write_lck{};
+			{
+				std::unique_lock<std::mutex> lck = lock_profiled(m_db_mtx);
+				if(!m_resumable) {
+					add_pending(local_word_freq, local_smileys);
+				} else if(end - length != m_pending_end) {
+					early_chunk& early = m_early_chunks[end - length];
+					early.end = end;
+					early.word_freq.merge(local_word_freq);
+					for(const auto& [code, positions]: local_smileys) {
+						early.smileys[code].append(positions);
+					}
+					return;
+				} else {
+					add_pending(local_word_freq, local_smileys);
+					m_pending_end = end;
+					for(auto it = m_early_chunks.begin(); it != m_early_chunks.end() && it->first == m_pending_end; it = m_early_chunks.erase(it)) {
+						add_pending(it->second.word_freq, it->second.smileys);
+						m_pending_end = it->second.end;
+					}
+				}
+				if(m_pending_chunks < m_db_batch_size) {
+					return;
+				}
+				batch_word_freq = std::move(m_pending_word_freq);
+				batch_smileys.swap(m_pending_smileys);
+				batch_end = m_pending_end;
+				m_pending_chunks = 0;
+				if(m_resumable) {
+					// the batches are committed in the order they are taken, so the checkpoint never passes an uncommitted one
+					write_lck = lock_profiled(m_db_write_mtx);
+				}
+			}
+			if(!write_lck.owns_lock()) {
+				write_lck = lock_profiled(m_db_write_mtx);
+			}
+			write_batch(batch_word_freq, batch_smileys, m_resumable ? std::optional<size_t>(batch_end) : std::nullopt);
+		}
+		void flush_pending() {
+			counter_type batch_word_freq{};
+			smileys_map batch_smileys{};
+			size_t batch_end = 0;
+			{
+				std::lock_guard<std::mutex> lck(m_db_mtx);
+				batch_word_freq = std::move(m_pending_word_freq);
+				batch_smileys.swap(m_pending_smileys);
+				batch_end = m_pending_end;
+				m_pending_chunks = 0;
 			}
-			cb();
+			std::lock_guard<std::mutex> write_lck(m_db_write_mtx);
+			write_batch(batch_word_freq, batch_smileys, m_resumable ? std::optional<size_t>(batch_end) : std::nullopt);
+		}
+		/*
+		 * Upserts the accumulated results of several chunks in a single transaction using the prepared statements,
+		 * the positions of a smiley are appended as a new row holding the encoded list of the batch.
+		 * The checkpoint is moved to the end of the batch by the same transaction. The caller holds the write mutex.
+		 */
+		void write_batch(const counter_type& word_freq, smileys_map& smileys, std::optional<size_t> checkpoint) {
+			if(word_freq.empty() && smileys.empty() && !checkpoint) {
+				return;
+			}
+			const libs::analysis::pipeline_profile::scoped_timer timer(m_profile.get(), libs::analysis::pipeline_stage::db_write);
+			m_db.get()->begin_transaction();
+			try {
+				for(const auto& [word, freq]: word_freq) {
+					m_upsert_word.get()->bind(1, word).bind(2, static_cast<sqlite3_int64>(freq)).execute();
+				}
+				for(auto& [code, positions]: smileys) {
+					positions.sort();
+					m_insert_smiley.get()->bind(1, code).bind_blob(2, positions.bytes()).execute();
+				}
+				if(checkpoint) {
+					m_update_checkpoint.get()->bind(1, static_cast<sqlite3_int64>(*checkpoint)).bind(2, m_checkpoint_path).execute();
+				}
+				m_db.get()->commit();
+			} catch(...) {
+				try {
+					m_db.get()->rollback();
+				} catch(...) {
+				}
+				throw;
+			}
+		}
+		/*
+		 * Gets the spill aggregator the workers fall back to once the memory limit is exceeded, it is created by the first spill.
+		 */
+		spill_aggregator<T, U>& fallback_spill() {
+			std::lock_guard<std::mutex> lck(m_spill_mtx);
+			if(!m_spill) {
+				m_spill = std::make_unique<spill_aggregator<T, U>>(m_spill_dir.empty() ? 
+						(std::filesystem::temp_directory_path() / "analyze_statistics").string() : m_spill_dir);
+			}
+			return *m_spill.get();
+		}
+		/*
+		 * Gets the footprint of the results kept in the ram-memory by the previous reads.
+		 */
+		size_t footprint() const {
+			size_t ret = m_word_freq.memory_usage();
+			for(const auto& [code, positions]: m_smileys) {
+				ret += positions.memory_usage();
+			}
+			return ret;
+		}
+		/*
+		 * Gets the positions of the smileys kept in the ram-memory joined with the spilled ones.
+		 */
+		smileys_map all_smileys() const {
+			if(!m_spill) {
+				return m_smileys;
+			}
+			smileys_map ret = m_spill.get()->smileys_to_map();
+			for(const auto& [code, positions]: m_smileys) {
+				ret[code].append(positions);
+			}
+			return ret;
+		}
+		/*
+		 * Locks the mutex, the time waited for it is recorded if the profiling is on.
+		 */
+		std::unique_lock<std::mutex> lock_profiled(std::mutex& mtx) {
+			if(!m_profile) {
+				return std::unique_lock<std::mutex>(mtx);
+			}
+			const auto start = libs::analysis::pipeline_profile::clock::now();
+			std::unique_lock<std::mutex> lck(mtx);
+			m_profile.get()->record_lock_wait(libs::analysis::pipeline_profile::clock::now() - start);
+			return lck;
 		}
 		void init() {
-			if(!std::filesystem::exists(m_file_path)) {
+			if(m_file_path != stdin_path && !std::filesystem::exists(m_file_path)) {
 				std::error_code ec;
 				throw std::filesystem::filesystem_error("Cant' find file " + m_file_path, 
 						std::move(m_file_path), ec);
@@ -43,40 +228,563 @@ class io_engine {
 			if(!m_db_name.empty()) {
 				m_db = std::move(std::make_unique<libs::db::db_engine>(m_db_name));
 				if(m_db.get()->open(m_db_name)) {
-					throw new libs::exception::custom_exception("Error: Can't open database");
+					throw libs::exception::custom_exception("Error: Can't open database");
 				}
-				if(m_db.get()->execute_command("DROP TABLE IF EXISTS FREQUENCY;")) {
-
-					throw new libs::exception::custom_exception("Error: Can't create table");
+				m_db.get()->tune_for_bulk_writes();
+				// the statistics of the previous run are dropped by the first read unless it resumes them
+				create_tables();
+			}
+		}
+		/*
+		 * Creates the tables which don't exist yet and compiles the statements.
+		 */
+		void create_tables() {
+			if(m_db.get()->execute_command("CREATE TABLE IF NOT EXISTS FREQUENCY (NAME TEXT PRIMARY KEY, ID INT);")) {
+				throw libs::exception::custom_exception("Error: Can't create table");
+			}
+			if(m_db.get()->execute_command("CREATE TABLE IF NOT EXISTS SMILEYS (CODE TEXT, POS BLOB);")) {
+				throw libs::exception::custom_exception("Error: Can't create table");
+			}
+			if(m_db.get()->execute_command("CREATE TABLE IF NOT EXISTS CHECKPOINT (PATH TEXT PRIMARY KEY, DEVICE INT, INODE INT, "
+						"HEAD_SIZE INT, HEAD_HASH INT, OFFSET INT);")) {
+				throw libs::exception::custom_exception("Error: Can't create table");
+			}
+			m_upsert_word = m_db.get()->prepare("INSERT INTO FREQUENCY (NAME, ID) VALUES (?, ?) ON CONFLICT(NAME) DO UPDATE SET ID = ID + excluded.ID;");
+			m_insert_smiley = m_db.get()->prepare("INSERT INTO SMILEYS (CODE, POS) VALUES (?, ?);");
+			m_update_checkpoint = m_db.get()->prepare("UPDATE CHECKPOINT SET OFFSET = ? WHERE PATH = ?;");
+		}
+		/*
+		 * Prepares the tables for the first read: the statistics of the previous run are kept if it is resumed and
+		 * the input is the same file it has read, otherwise they are dropped. Returns the offset the input is read from.
+		 */
+		size_t open_checkpoint() {
+			m_checkpoint_path = std::filesystem::absolute(m_file_path).lexically_normal().string();
+			if(m_resumable) {
+				std::unique_ptr<libs::db::statement> select = m_db.get()->prepare(
+						"SELECT DEVICE, INODE, HEAD_SIZE, HEAD_HASH, OFFSET FROM CHECKPOINT WHERE PATH = ?;");
+				select.get()->bind(1, m_checkpoint_path);
+				if(select.get()->step()) {
+					file_identity stored{};
+					stored.device = select.get()->column_int(0);
+					stored.inode = select.get()->column_int(1);
+					stored.head_size = select.get()->column_int(2);
+					stored.head_hash = select.get()->column_int(3);
+					const size_t offset = select.get()->column_int(4);
+					std::error_code ec;
+					const size_t size = std::filesystem::file_size(m_file_path, ec);
+					// a rotated or a truncated file is read again from its beginning
+					if(!ec && offset <= size && file_identity::of(m_file_path, stored.head_size) == stored) {
+						return offset;
+					}
+				}
+			}
+			m_upsert_word.reset();
+			m_insert_smiley.reset();
+			m_update_checkpoint.reset();
+			for(const char* table: {"FREQUENCY", "SMILEYS", "CHECKPOINT"}) {
+				if(m_db.get()->execute_command(std::string("DROP TABLE IF EXISTS ") + table + ";")) {
+					throw libs::exception::custom_exception("Error: Can't create table");
+				}
+			}
+			create_tables();
+			return 0;
+		}
+		/*
+		 * Whether a read counts only the part of the input appended since the previous one.
+		 */
+		bool tail_mode() const {
+			return m_resumable || m_following;
+		}
+		/*
+		 * Passes the counts of the words read by the last read to the top tracker, `counter` holds either the new totals
+		 * or the increments of the totals kept by the engine.
+		 */
+		void update_top(const counter_type& counter, bool totals) {
+			if(!m_top_tracker) {
+				return;
+			}
+			for(const auto& [word, freq]: counter) {
+				const U total = totals ? freq : *m_word_freq.find(word);
+				m_top_tracker.get()->update(word, total - freq, total);
+			}
+		}
+		/*
+		 * Drops the statistics of the followed file once it has been rotated or truncated, the new file is read from its beginning.
+		 */
+		void restart_following() {
+			m_word_freq.clear();
+			m_smileys.clear();
+			if(m_top_tracker) {
+				m_top_tracker.get()->clear();
+			}
+			if(m_spill) {
+				m_spill.get()->clear();
+			}
+			m_checkpoint = 0;
+			// the tables are dropped by the next read unless it resumes a checkpoint of the same file
+			m_tables_ready = false;
+		}
+		/*
+		 * Reads the part of the input appended since the checkpoint up to its last complete line, the line which is
+		 * still being appended is left for the next run. The identity of the file is recorded before the reading if the runs are resumed.
+		 */
+		void read_tail(libs::analysis::analyze_stats_engine<T, U>& stats) {
+			const size_t first = m_checkpoint;
+			m_resumed_from = first;
+			const size_t last = complete_lines_end(m_file_path, first, std::filesystem::file_size(m_file_path));
+			m_tail_end = last;
+			if(m_resumable) {
+				const file_identity identity = file_identity::of(m_file_path, std::min(last, file_identity::head_limit));
+				std::lock_guard<std::mutex> write_lck(m_db_write_mtx);
+				std::unique_ptr<libs::db::statement> upsert = m_db.get()->prepare(
+						"INSERT INTO CHECKPOINT (PATH, DEVICE, INODE, HEAD_SIZE, HEAD_HASH, OFFSET) VALUES (?, ?, ?, ?, ?, ?) "
+						"ON CONFLICT(PATH) DO UPDATE SET DEVICE = excluded.DEVICE, INODE = excluded.INODE, "
+						"HEAD_SIZE = excluded.HEAD_SIZE, HEAD_HASH = excluded.HEAD_HASH, OFFSET = excluded.OFFSET;");
+				upsert.get()->bind(1, m_checkpoint_path).bind(2, static_cast<sqlite3_int64>(identity.device))
+					.bind(3, static_cast<sqlite3_int64>(identity.inode)).bind(4, static_cast<sqlite3_int64>(identity.head_size))
+					.bind(5, static_cast<sqlite3_int64>(identity.head_hash)).bind(6, static_cast<sqlite3_int64>(first)).execute();
+			}
+			{
+				std::lock_guard<std::mutex> lck(m_db_mtx);
+				m_pending_end = first;
+			}
+			if(last > first) {
+				read_range(stats, first, last);
+			}
+		}
+		/*
+		 * Gets the size of the next chunk: the fixed block size or the size tuned from the workers' progress.
+		 */
+		size_t next_block_size(const libs::analysis::analyze_stats_engine<T, U>& stats) {
+			if(!m_chunk_sizer) {
+				return std::max<size_t>(m_block_size, 1);
+			}
+			const libs::analysis::processing_progress progress = stats.get_progress();
+			return m_chunk_sizer.get()->update(progress.chunks, progress.bytes, progress.busy_time, 
+					stats.get_pending_count(), stats.get_queue_capacity());
+		}
+		/*
+		 * Reads the file by the blocks of the stream, the part of a block after its last space is carried over to the next chunk,
+		 * so a token longer than the block is read until its end instead of being seeked back to.
+		 */
+		void read_stream(libs::analysis::analyze_stats_engine<T, U>& stats) {
+			const libs::analysis::pipeline_profile::scoped_timer timer(m_profile.get(), libs::analysis::pipeline_stage::read);
+			std::ifstream is(m_file_path, std::ios::binary);
+			if(!is) {
+				const std::string err_msg("Error: Can't open file: " + m_file_path);
+				throw libs::exception::custom_exception(err_msg.c_str());
+			}
+			read_forward(stats, is, 0, std::string::npos);
+		}
+		/*
+		 * Splits the file into the ranges of roughly equal size, every inner boundary is moved forward to the next space,
+		 * so neither a word nor a smiley is split between two ranges.
+		 */
+		std::vector<size_t> split_ranges(size_t length, size_t ranges_count) const {
+			std::vector<size_t> bounds{0};
+			std::ifstream is(m_file_path, std::ios::binary);
+			std::vector<char> buffer(4096);
+			for(size_t i = 1; i < ranges_count; ++i) {
+				size_t bound = std::max(bounds.back(), length / ranges_count * i);
+				is.clear();
+				is.seekg(bound);
+				while(bound < length) {
+					is.read(buffer.data(), std::min(buffer.size(), length - bound));
+					const size_t got = is.gcount();
+					if(got == 0) {
+						bound = length;
+						break;
+					}
+					const auto space = std::find(buffer.begin(), buffer.begin() + got, ' ');
+					if(space != buffer.begin() + got) {
+						bound += space - buffer.begin();
+						break;
+					}
+					bound += got;
+				}
+				bounds.push_back(std::min(bound, length));
+			}
+			bounds.push_back(length);
+			return bounds;
+		}
+		/*
+		 * Reads the stream forward by blocks, a chunk ends at the last space of the block and the rest is carried over
+		 * to the next chunk, so the stream is never seeked. The reading stops at `last` or at the end of the stream if it is `npos`.
+		 * Returns the position the reading has stopped at.
+		 */
+		size_t read_forward(libs::analysis::analyze_stats_engine<T, U>& stats, std::istream& is, size_t first, size_t last) {
+			std::string chunk{};
+			size_t pos = first;
+			while(pos < last) {
+				const size_t carried = chunk.size();
+				const size_t want = std::min(next_block_size(stats), last - pos);
+				chunk.resize(carried + want);
+				is.read(chunk.data() + carried, want);
+				const size_t got = is.gcount();
+				chunk.resize(carried + got);
+				if(got == 0) {
+					if(last != std::string::npos) {
+						throw libs::exception::custom_exception("Error: Unexpected end of the input file");
+					}
+					break;
+				}
+				pos += got;
+				if(pos == last) {
+					break;
 				}
-				if(m_db.get()->execute_command("CREATE TABLE FREQUENCY (NAME TEXT PRIMARY KEY, ID INT);")) {
-					throw new libs::exception::custom_exception("Error: Can't create table");
+				const std::size_t found = chunk.find_last_of(' ');
+				if(found == 0 || found == std::string::npos) {
+					// a single token is longer than the block, keep reading until its end
+					continue;
 				}
-				if(m_db.get()->execute_command("DROP TABLE IF EXISTS SMILEYS;")) {
-					throw new libs::exception::custom_exception("Error: Can't create table");
+				std::string rest = chunk.substr(found);
+				chunk.resize(found);
+				handler(stats, {std::move(chunk), pos - rest.size(), found});
+				chunk = std::move(rest);
+			}
+			if(!chunk.empty()) {
+				const size_t chunk_length = chunk.size();
+				handler(stats, {std::move(chunk), pos, chunk_length});
+			}
+			return pos;
+		}
+		/*
+		 * Reads the byte range of the file, it is called by every thread of the parallel reader.
+		 */
+		void read_range(libs::analysis::analyze_stats_engine<T, U>& stats, size_t first, size_t last) {
+			const libs::analysis::pipeline_profile::scoped_timer timer(m_profile.get(), libs::analysis::pipeline_stage::read);
+			std::ifstream is(m_file_path, std::ios::binary);
+			is.seekg(first);
+			read_forward(stats, is, first, last);
+		}
+		/*
+		 * Reads the input forward and decodes it if it is compressed, the positions start at `base`.
+		 * The input is decoded by the reader thread while the workers count the previous chunks.
+		 * The decoded size of the compressed and the streamed inputs is known only once they are read, so `limit` is checked then.
+		 */
+		compression_type read_decoded(libs::analysis::analyze_stats_engine<T, U>& stats, const std::string& path, size_t base, 
+				size_t limit = std::string::npos) {
+			const libs::analysis::pipeline_profile::scoped_timer timer(m_profile.get(), libs::analysis::pipeline_stage::read);
+			std::ifstream file{};
+			std::streambuf* source = std::cin.rdbuf();
+			if(path != stdin_path) {
+				file.open(path, std::ios::binary);
+				if(!file) {
+					const std::string err_msg("Error: Can't open file: " + path);
+					throw libs::exception::custom_exception(err_msg.c_str());
 				}
-				if(m_db.get()->execute_command("CREATE TABLE SMILEYS (CODE TEXT PRIMARY KEY, POS TEXT);")) {
-					throw new libs::exception::custom_exception("Error: Can't create table");
+				source = file.rdbuf();
+			}
+			decoding_streambuf decoded(source);
+			std::istream is(&decoded);
+			const size_t end = read_forward(stats, is, base, std::string::npos);
+			if(is.bad()) {
+				throw libs::exception::custom_exception("Error: Can't read the input");
+			}
+			if(end - base >= limit) {
+				const std::string err_msg("Error: The input is too large to be read with the other inputs: " + path);
+				throw libs::exception::custom_exception(err_msg.c_str());
+			}
+			return decoded.compression();
+		}
+		/*
+		 * Reads the standard input or the pipe, the socket, etc. which can't be seeked, and the compressed inputs.
+		 */
+		void read_streamed(libs::analysis::analyze_stats_engine<T, U>& stats) {
+			m_compression = read_decoded(stats, m_file_path, 0);
+		}
+		/*
+		 * Reads the input files by several threads, every thread takes the next file once it has finished the previous one,
+		 * so the workers get the chunks of several files at once. The positions of every file start at its own base.
+		 * The first exception of a reader is rethrown once all the readers are joined.
+		 */
+		void read_inputs(libs::analysis::analyze_stats_engine<T, U>& stats) {
+			// the positions of a file must stay below the bits of the file index, otherwise they would fall into the next file
+			const size_t limit = size_t(1) << libs::utils::input_offset_bits;
+			for(const auto& path: m_inputs) {
+				std::error_code ec;
+				if(path != stdin_path && std::filesystem::is_regular_file(path, ec) && std::filesystem::file_size(path, ec) >= limit) {
+					const std::string err_msg("Error: The input is too large to be read with the other inputs: " + path);
+					throw libs::exception::custom_exception(err_msg.c_str());
 				}
 			}
+			const size_t readers_count = std::min(m_readers_count == 0 ? m_workers_count : m_readers_count, m_inputs.size());
+			std::atomic<size_t> next_input{0};
+			std::vector<std::thread> readers{};
+			std::exception_ptr error{};
+			std::mutex error_mtx;
+			for(size_t i = 0; i < std::max<size_t>(readers_count, 1); ++i) {
+				readers.emplace_back([this, &stats, &next_input, &error, &error_mtx, limit]() {
+						try {
+							for(size_t input = next_input++; input < m_inputs.size(); input = next_input++) {
+								read_decoded(stats, m_inputs[input], input << libs::utils::input_offset_bits, limit);
+							}
+						} catch(...) {
+							std::lock_guard<std::mutex> lck(error_mtx);
+							if(!error) {
+								error = std::current_exception();
+							}
+							// the other readers stop after their current file
+							next_input = m_inputs.size();
+						}
+						});
+			}
+			for(auto& reader: readers) {
+				reader.join();
+			}
+			if(error) {
+				std::rethrow_exception(error);
+			}
+		}
+		static const std::string& first_input(const std::vector<std::string>& file_paths) {
+			if(file_paths.empty()) {
+				throw libs::exception::custom_exception("Error: No input files");
+			}
+			return file_paths.front();
+		}
+		/*
+		 * Formats the position, it is qualified by the file if several files are read.
+		 */
+		std::string format_position(U pos) const {
+			if(m_inputs.empty()) {
+				return std::to_string(pos);
+			}
+			const auto [input, local] = split_position(pos);
+			return m_inputs[input] + ":" + std::to_string(local);
+		}
+		/*
+		 * Reads the rows appended by the batches, joins the lists of every smiley and formats them like a single `CODE`, `POS` row each.
+		 */
+		std::vector<std::pair<T, T>> query_smileys() {
+			std::vector<std::pair<T, libs::datastructure::position_list<U>>> smileys{};
+			std::unordered_map<T, size_t> index{};
+			std::unique_ptr<libs::db::statement> select = m_db.get()->prepare("SELECT CODE, POS FROM SMILEYS ORDER BY ROWID;");
+			while(select.get()->step()) {
+				T code = select.get()->column_text(0);
+				const auto [it, inserted] = index.emplace(code, smileys.size());
+				if(inserted) {
+					smileys.emplace_back(std::move(code), libs::datastructure::position_list<U>());
+				}
+				smileys[it->second].second.append(libs::datastructure::position_list<U>::from_bytes(select.get()->column_blob(1)));
+			}
+			std::vector<std::pair<T, T>> ret{};
+			for(auto& [code, positions]: smileys) {
+				positions.sort();
+				T pos_str{};
+				positions.for_each([this, &pos_str](U pos) {
+						pos_str += format_position(pos) + " ";
+						});
+				ret.push_back(std::make_pair("CODE", code));
+				ret.push_back(std::make_pair("POS", pos_str));
+			}
+			return ret;
+		}
+		/*
+		 * Detects the compression of the regular file by its first bytes, the streamed inputs are detected while they are read.
+		 */
+		compression_type peek_compression() const {
+			if(is_streamed()) {
+				return compression_type::none;
+			}
+			std::ifstream is(m_file_path, std::ios::binary);
+			char magic[4] = {};
+			is.read(magic, sizeof(magic));
+			return detect_compression(magic, is.gcount());
+		}
+		/*
+		 * Reads the file by several threads, each owns a byte range.
+		 * The first exception of a reader is rethrown once all the readers are joined.
+		 */
+		void read_parallel(libs::analysis::analyze_stats_engine<T, U>& stats) {
+			const size_t length = std::filesystem::file_size(m_file_path);
+			if(length == 0) {
+				return;
+			}
+			const size_t readers_count = m_readers_count == 0 ? m_workers_count : m_readers_count;
+			const std::vector<size_t> bounds = split_ranges(length, std::max<size_t>(readers_count, 1));
+			std::vector<std::thread> readers{};
+			std::exception_ptr error{};
+			std::mutex error_mtx;
+			for(size_t i = 0; i + 1 < bounds.size(); ++i) {
+				if(bounds[i] == bounds[i + 1]) {
+					continue;
+				}
+				readers.emplace_back([this, &stats, &bounds, &error, &error_mtx, i]() {
+						try {
+							read_range(stats, bounds[i], bounds[i + 1]);
+						} catch(...) {
+							std::lock_guard<std::mutex> lck(error_mtx);
+							if(!error) {
+								error = std::current_exception();
+							}
+						}
+						});
+			}
+			for(auto& reader: readers) {
+				reader.join();
+			}
+			if(error) {
+				std::rethrow_exception(error);
+			}
+		}
+		/*
+		 * Reads the file by the asynchronous reader and cuts the blocks into chunks at the last space,
+		 * the text after it is carried over to the next chunk.
+		 */
+		void read_async(libs::analysis::analyze_stats_engine<T, U>& stats) {
+			const libs::analysis::pipeline_profile::scoped_timer timer(m_profile.get(), libs::analysis::pipeline_stage::read);
+			async_file_reader file(m_file_path, async_file_reader::default_block_size, m_io_depth, m_async_backend, m_direct_io);
+			m_async_backend_used = file.backend();
+			std::string chunk{};
+			size_t pos = 0;
+			while(std::optional<std::string_view> data = file.next()) {
+				chunk.append(data.value());
+				pos += data.value().size();
+				size_t start = 0;
+				// the size is taken once per chunk, so the chunk is cut at the size the loop has checked
+				for(size_t want = next_block_size(stats); chunk.size() - start >= want; want = next_block_size(stats)) {
+					std::size_t found = chunk.rfind(' ', start + want);
+					if(found == std::string::npos || found <= start) {
+						// a single token is longer than the block, the chunk ends after it
+						found = chunk.find(' ', start + want);
+						if(found == std::string::npos) {
+							break;
+						}
+					}
+					const size_t chunk_length = found - start;
+					handler(stats, {chunk.substr(start, chunk_length), pos - (chunk.size() - found), chunk_length});
+					start = found;
+				}
+				chunk.erase(0, start);
+			}
+			if(!chunk.empty()) {
+				const size_t chunk_length = chunk.size();
+				handler(stats, {std::move(chunk), pos, chunk_length});
+			}
+		}
+		/*
+		 * Maps the file by sliding windows and hands out the chunks as views into the mapping.
+		 * Each chunk holds a reference to its window, so the window is unmapped once the workers are done with it.
+		 */
+		void read_mapped(libs::analysis::analyze_stats_engine<T, U>& stats) {
+			const libs::analysis::pipeline_profile::scoped_timer timer(m_profile.get(), libs::analysis::pipeline_stage::read);
+			mapped_file file(m_file_path);
+			const size_t length = file.size();
+			size_t window_size = m_mapped_window_size;
+			size_t pos = 0;
+			while(pos < length) {
+				window_size = std::max(window_size, 2 * next_block_size(stats));
+				std::shared_ptr<const mapped_file::window> window = file.map(pos, window_size);
+				const std::string_view data = window.get()->data();
+				const size_t window_end = pos + data.size();
+				size_t start = pos;
+				while(start < length) {
+					size_t end = std::min(start + next_block_size(stats), length);
+					if(end < length) {
+						if(end >= window_end) {
+							break;
+						}
+						if(data[end - pos] != ' ') {
+							const std::size_t found = data.substr(start - pos, end - start).find_last_of(' ');
+							if(found != std::string_view::npos && found != 0) {
+								end = start + found;
+							} else {
+								const std::size_t next = data.find(' ', end - pos);
+								end = (next == std::string_view::npos) ? length : pos + next;
+							}
+						}
+					}
+					if(end > window_end) {
+						break;
+					}
+					stats.submit(libs::utils::text_span(data.substr(start - pos, end - start), window), end);
+					start = end;
+				}
+				if(start == pos) {
+					// A single token doesn't fit into the window
+					window_size *= 2;
+				}
+				pos = start;
+			}
+		}
+		/*
+		 * Sets the attributes of the last run to the profile, i.e. how the input was read and chunked and how the work was scheduled.
+		 */
+		void describe_run() {
+			libs::analysis::pipeline_profile& profile = *m_profile.get();
+			static constexpr const char* readers[] = {"ifstream", "mmap", "parallel", "async", "forward"};
+			static constexpr const char* compressions[] = {"none", "gzip", "zstd"};
+			profile.set_attribute("reader", readers[static_cast<size_t>(m_reader_used)]);
+			if(m_reader_used == reader_type::async) {
+				profile.set_attribute("async_backend", m_async_backend_used == async_backend::io_uring ? "io_uring" : "pread");
+				profile.set_attribute("io_depth", m_io_depth);
+			}
+			profile.set_attribute("compression", compressions[static_cast<size_t>(m_compression)]);
+			profile.set_attribute("inputs", std::max<size_t>(m_inputs.size(), 1));
+			profile.set_attribute("workers", m_workers_count);
+			profile.set_attribute("kernel", m_kernel == libs::analysis::analysis_kernel::fused ? "fused" : "split");
+			profile.set_attribute("scheduler", m_scheduler == libs::analysis::scheduler_type::work_stealing ? "stealing" : "queue");
+			profile.set_attribute("chunk_size", get_block_size());
+			if(m_chunk_sizer) {
+				profile.set_attribute("chunk_size_smallest", m_chunk_sizer.get()->smallest());
+				profile.set_attribute("chunk_size_largest", m_chunk_sizer.get()->largest());
+				profile.set_attribute("chunk_size_adjustments", m_chunk_sizer.get()->adjustments());
+			}
+			profile.set_attribute("database", !m_db_name.empty() ? "sqlite" : "none");
+			if(m_resumable) {
+				profile.set_attribute("resumed_from", m_resumed_from);
+				profile.set_attribute("checkpoint", m_checkpoint);
+			}
+			profile.set_attribute("spilled_runs", get_spilled_runs_count());
+			if(m_memory_limit != 0) {
+				profile.set_attribute("memory_limit", m_memory_limit);
+				profile.set_attribute("peak_footprint", m_peak_footprint);
+				profile.set_attribute("out_of_core", m_spill ? "spill" : "none");
+			}
+			if(!m_scheduler_stats.empty()) {
+				std::string workers("[");
+				for(const auto& worker: m_scheduler_stats) {
+					workers += (workers.size() > 1 ? ", " : "") + std::string("{\"executed\": ") + std::to_string(worker.executed) +
+						", \"steals\": " + std::to_string(worker.steals) + ", \"stolen_tasks\": " + std::to_string(worker.stolen_tasks) +
+						", \"idle_ns\": " + std::to_string(worker.idle_time.count()) + "}";
+				}
+				profile.set_raw_attribute("scheduler_workers", workers + "]");
+			}
 		}
 	public:
+		/// The input file path which stands for the standard input
+		static constexpr const char* stdin_path = "-";
 		/**
 		 * The constructor with arguments
 		 *
-		 * \param file_path the path of the input text file
+		 * \param file_path the path of the input text file, a pipe or `-` for the standard input
 		 * \param block_size the size of a block which is using to read the input file by chunks
 		 * \param db_name the name of a database which could be used to process very large files that can't loaded into theram-memory at once.
 		 *      It has default empty string value `""`. If this argument is defined then the database will be used to keep datas on a persisent disk, 
 		 *      othewise the ram-memory will be used instead.
+		 * \param workers_count the number of worker threads analyzing the chunks while the file is being read.
+		 *      It has default `0` value which means the number of hardware threads.
 		 */
-		io_engine(const std::string& file_path, size_t block_size, const std::string& db_name=""): 
+		io_engine(const std::string& file_path, size_t block_size, const std::string& db_name="", size_t workers_count=0): 
 			m_file_path(file_path), 
 			m_block_size(block_size),
-		        m_queue(std::make_unique<libs::safe_datastructure::task_queue<T, U>>()),
+			m_workers_count(workers_count == 0 ? libs::analysis::analyze_stats_engine<T, U>::default_workers_count() : workers_count),
+		        m_queue(std::make_unique<queue_type>(m_workers_count * pending_tasks_per_worker)),
 	                m_db_name(db_name) {
 				init();
 			}
+		/**
+		 * The constructor with arguments which reads several files into the same statistics
+		 *
+		 * \param file_paths the paths of the input text files, see `set_inputs`
+		 * \param block_size the size of a block which is using to read the input files by chunks
+		 * \param db_name the name of a database, see the constructor above
+		 * \param workers_count the number of worker threads, the files are read by as many threads unless `set_readers_count` says otherwise
+		 */
+		io_engine(const std::vector<std::string>& file_paths, size_t block_size, const std::string& db_name="", size_t workers_count=0): 
+			io_engine(first_input(file_paths), block_size, db_name, workers_count) {
+				set_inputs(file_paths);
+			}
 		/**
 		 * The copy constructor deleted
 		 */		 
@@ -98,68 +806,133 @@ class io_engine {
 		 * @returns void
 		 */
 		void read() {
-			std::ifstream is(m_file_path);
-			is.seekg (0, is.end);
-			int length = is.tellg();
-			is.seekg (0, is.beg);
-			if(m_block_size > length) {
-				m_block_size = length;
-			}
-			std::vector<char> buffer (m_block_size, 0);
-			while (!is.eof()) {
-				std::istream& ist = is.read(buffer.data(), buffer.size());
-				std::streamsize size = is.gcount();
-				int c = ist.peek();
-				std::string val(buffer.begin(), buffer.begin() + size);
-				if(!is.eof() && c != ' ') {
-					std::size_t found = val.find_last_of(" ");
-					val = val.substr(0, found);
-					is.seekg(is.tellg() - (unsigned)(m_block_size - found), std::ios_base::beg);
-				}
-				if(m_queue) {
-					size_t pos = is.tellg();
-					std::unordered_map<T, U> local_word_freq{};
-					std::unordered_map<T, std::vector<U>> local_smileys{};
-					if(is.eof()) {
-						pos = length;
-					}
-					handler({val, pos, val.length()}, [this, &local_word_freq, &local_smileys](){
-							libs::analysis::analyze_stats_engine<T, U> stats(std::move(m_queue));
-							stats.analyze();
-							std::unordered_map<T, U> word_freq = stats.get_map();
-							std::unordered_map<T, std::vector<U>> smileys = stats.get_smileys();
-							local_word_freq = stats.get_map();
-							local_smileys = stats.get_smileys();
-							for(auto&[word, freq]: word_freq) {
-							    m_word_freq[word] += freq;
-							}
-							m_smileys.insert(smileys.begin(), smileys.end());
-							m_queue = std::move(stats.get_task_queue());
-							;});
-					if(!m_db_name.empty()) {
-						for(auto& [word, freq]: local_word_freq) {
-							if(m_db.get()->execute_command("INSERT INTO FREQUENCY (NAME, ID) VALUES (\"" + word + "\","+ std::to_string(freq) + ") ON CONFLICT(NAME) DO UPDATE SET ID = ID + " + std::to_string(freq) + ";")) {
-								throw new libs::exception::custom_exception("Error: Can't insert/update table");
-							}
-						}
-						for(auto& [code, positions]: local_smileys) {
-							std::string pos_str{};
-							for(auto& pos: positions) {
-								pos_str += std::to_string(pos) + " ";
-							}
-							if(m_db.get()->execute_command("INSERT INTO SMILEYS (CODE, POS) VALUES('" + code + "','" + pos_str + "');")) {
-								throw new libs::exception::custom_exception("Error: Can't insert/update table");
-							}
-						}
+			if(!m_queue) {
+				return;
+			}
+			if(m_resumable && (!m_inputs.empty() || is_streamed() || peek_compression() != compression_type::none)) {
+				throw libs::exception::custom_exception("Error: Only a single regular uncompressed file can be resumed");
+			}
+			if(m_db && !m_tables_ready) {
+				m_checkpoint = open_checkpoint();
+				m_tables_ready = true;
+			}
+			const auto run_start = libs::analysis::pipeline_profile::clock::now();
+			libs::analysis::analyze_stats_engine<T, U> stats(std::move(m_queue), m_workers_count);
+			stats.set_profile(m_profile.get());
+			stats.set_smileys(m_smiley_set);
+			stats.set_kernel(m_kernel);
+			stats.set_scheduler(m_scheduler);
+			if(m_adaptive_block_size) {
+				// the measurements start over with the new engine, the size tuned by the previous read is kept
+				m_chunk_sizer = std::make_unique<chunk_size_controller>(m_chunk_sizer ? m_chunk_sizer.get()->size() : 
+						chunk_size_controller::default_initial_size);
+			}
+			if(!m_db_name.empty()) {
+				stats.set_chunk_observer([this](const counter_type& local_word_freq, 
+							const smileys_map& local_smileys, U end, size_t length) {
+						store_chunk(local_word_freq, local_smileys, end, length);
+						});
+			}
+			if(m_spill) {
+				spill_aggregator<T, U>* spill = m_spill.get();
+				stats.set_spill_handler(std::max<size_t>(m_memory_budget / m_workers_count, 1), 
+						[spill](const counter_type& word_freq, const smileys_map& smileys) {
+						spill->spill(word_freq);
+						spill->spill_smileys(smileys);
+						});
+			} else if(m_memory_limit != 0) {
+				// the tables are kept under half of the limit as merging them takes about as much again
+				stats.set_spill_handler(std::max<size_t>(m_memory_budget / m_workers_count, 1), 
+						[this](const counter_type& word_freq, const smileys_map& smileys) {
+						spill_aggregator<T, U>& spill = fallback_spill();
+						spill.spill(word_freq);
+						spill.spill_smileys(smileys);
+						});
+				stats.set_memory_limit(m_memory_budget, footprint());
+			}
+			stats.start();
+			try {
+				if(tail_mode()) {
+					m_reader_used = reader_type::forward;
+					read_tail(stats);
+				} else if(!m_inputs.empty()) {
+					m_reader_used = reader_type::forward;
+					read_inputs(stats);
+				} else {
+					m_compression = peek_compression();
+					m_reader_used = is_streamed() || m_compression != compression_type::none ? reader_type::forward : m_reader;
+					switch(m_reader_used) {
+						case reader_type::forward:
+							read_streamed(stats);
+							break;
+						case reader_type::mapped:
+							read_mapped(stats);
+							break;
+						case reader_type::parallel:
+							read_parallel(stats);
+							break;
+						case reader_type::async:
+							read_async(stats);
+							break;
+						default:
+							read_stream(stats);
+							break;
 					}
 				}
+			} catch(...) {
+				// the workers are stopped before the queue is taken back, the reader's error is the one reported
+				try {
+					stats.wait();
+				} catch(...) {
+				}
+				m_queue = std::move(stats.get_task_queue());
+				throw;
+			}
+			stats.wait();
+			if(!m_db_name.empty()) {
+				flush_pending();
+			}
+			if(tail_mode()) {
+				m_checkpoint = m_tail_end;
+			}
+			{
+				const libs::analysis::pipeline_profile::scoped_timer timer(m_profile.get(), libs::analysis::pipeline_stage::merge);
+				if(m_word_freq.empty()) {
+					m_word_freq = stats.take_counter();
+					update_top(m_word_freq, true);
+				} else {
+					m_word_freq.merge(stats.get_counter());
+					update_top(stats.get_counter(), false);
+				}
+				for(const auto& [code, positions]: stats.take_smileys()) {
+					m_smileys[code].append(positions);
+				}
+			}
+			m_peak_footprint = std::max(m_peak_footprint, stats.get_peak_footprint());
+			if(m_spill && m_top_tracker) {
+				// the counts are merged from the spilled runs from now on, they are ranked when queried
+				m_top_tracker.reset();
+			}
+			if(m_spill && (!m_word_freq.empty() || !m_smileys.empty())) {
+				// the limit has been exceeded, the tables the workers had kept and the results of the previous reads follow the spilled runs
+				const libs::analysis::pipeline_profile::scoped_timer timer(m_profile.get(), libs::analysis::pipeline_stage::spill);
+				m_spill.get()->spill(m_word_freq);
+				m_spill.get()->spill_smileys(m_smileys);
+				m_word_freq.clear();
+				m_smileys.clear();
+			}
+			m_scheduler_stats = stats.get_scheduler_stats();
+			m_queue = std::move(stats.get_task_queue());
+			if(m_profile) {
+				m_profile.get()->add_wall_time(libs::analysis::pipeline_profile::clock::now() - run_start);
+				describe_run();
 			}
 		}
 		/**
 		 * Gets the task queue
 		 * @returns task queue object
 		 */
-		std::unique_ptr<libs::safe_datastructure::task_queue<T, U>> get_task_queue() {
+		std::unique_ptr<queue_type> get_task_queue() {
 			return std::move(m_queue);
 		}
 		/**
@@ -167,31 +940,37 @@ class io_engine {
 		 * @returns `std::unordered_map<T, U>` where keys are the words and the values are their frequencies
 		 */
 		std::unordered_map<T, U> get_map() {
-			return m_word_freq;
+			if(m_spill) {
+				return m_spill.get()->to_map();
+			}
+			return m_word_freq.to_map();
 		}
 		/**
-		 * Gets a hash map which represents smileys and their positions in the input text
+		 * Gets a hash map which represents smileys and their positions in the input text, the positions of several input files
+		 * are split by `split_position`
 		 * @returns `std::unordered_map<T, std::vector<U>>>` where the key is a smiley character and the value is it's positions
 		 */
 		std::unordered_map<T, std::vector<U>> get_smileys_map() {
-			return m_smileys;
+			std::unordered_map<T, std::vector<U>> ret{};
+			for(const auto& [code, positions]: all_smileys()) {
+				ret.emplace(code, positions.to_vector());
+			}
+			return ret;
 		}
 		/**
 		 * Performs a db query, obtains smiles and their positions then converts it `std::vector`
 		 * @returns `std::vector<std::pair<T, T>>` where the key is a smiley character and the value is it's positions
 		 */
 		std::vector<std::pair<T, T>> get_smileys(callback2&& cb) {
+			const libs::analysis::pipeline_profile::scoped_timer timer(m_profile.get(), libs::analysis::pipeline_stage::query);
 			if(!m_db_name.empty()) {
-				if(m_db.get()->execute_command("SELECT CODE, POS FROM SMILEYS;")) {
-					throw new libs::exception::custom_exception("Error: query failed");
-				}
-				return m_db.get()->get_and_clear_last_query_result();
+				return query_smileys();
 			}
 			std::vector<std::pair<T, T>> ret{};
-			for(auto& [code, positions]: m_smileys) {
-				for(auto& pos: positions) {
+			for(auto& [code, positions]: all_smileys()) {
+				for(auto& pos: positions.to_vector()) {
 					T key = code;
-					T cast = cb(pos);
+					T cast = m_inputs.empty() ? cb(pos) : T(m_inputs[split_position(pos).first] + ":") + cb(split_position(pos).second);
 					T value = cast;
 					std::pair<T, T> pair_one = std::make_pair("Code", key);
 					std::pair<T, T> pair_two = std::make_pair("Id", value);
@@ -206,40 +985,75 @@ class io_engine {
 		 * @returns `std::vector<std::pair<T, T>>` where the key is a word and the value is frequency in the input text
 		 */
 		std::vector<std::pair<T, T>> query_n_most_frequent(const size_t n, callback2&& cb) {
+			const libs::analysis::pipeline_profile::scoped_timer timer(m_profile.get(), libs::analysis::pipeline_stage::query);
 			if(!m_db_name.empty()) {
-				if(m_db.get()->execute_command("SELECT * FROM FREQUENCY order by ID desc limit " + std::to_string(n) + ";")) {
-					throw new libs::exception::custom_exception("Error: query failed");
+				if(m_db.get()->execute_command("SELECT * FROM FREQUENCY order by ID desc, NAME limit " + std::to_string(n) + ";")) {
+					throw libs::exception::custom_exception("Error: query failed");
 				}
 				return m_db.get()->get_and_clear_last_query_result();
 			}
-			const size_t size = m_word_freq.size();
-			std::vector<std::vector<T>> counting_vector = std::vector(size, std::vector<T>());
-			for(auto& [word, freq]: m_word_freq) {
-				counting_vector[freq].push_back(word);
+			if(m_spill) {
+				std::vector<std::pair<T, T>> ret{};
+				for(auto& [word, freq]: m_spill.get()->top_n(n)) {
+					ret.push_back(std::make_pair("Word", word));
+					ret.push_back(std::make_pair("Id", cb(freq)));
+				}
+				return ret;
 			}
 			std::vector<std::pair<T, T>> ret{};
-			int k = 0;
-			for(int i = counting_vector.size() - 1; i >=0; --i) {
-				if(!counting_vector[i].empty()) {
-					for(int j = 0; j < counting_vector[i].size(); ++j) {
-						if(k >= n) {
-							break;
-						}
-						T key = counting_vector[i][j];
-						T cast = cb(i);
-						T value = cast;
-						std::pair<T, T> pair_one = std::make_pair("Word", key);
-						std::pair<T, T> pair_two = std::make_pair("Id", value);
-						ret.push_back(pair_one);
-						ret.push_back(pair_two);
-						++k;
-					}
-				} else if(k >= n) {
-					break;
+			if(m_top_tracker && n <= m_top_tracker.get()->capacity()) {
+				for(const auto& [word, freq]: m_top_tracker.get()->top(n)) {
+					ret.push_back(std::make_pair("Word", T(word)));
+					ret.push_back(std::make_pair("Id", cb(freq)));
 				}
+				return ret;
+			}
+			for(const auto& [word, freq]: m_word_freq.top_n(n, m_workers_count)) {
+				ret.push_back(std::make_pair("Word", T(word)));
+				ret.push_back(std::make_pair("Id", cb(freq)));
 			}
 			return ret;
 		}
+		/**
+		 * Writes the full word counts and the smiley positions read so far to a snapshot file,
+		 * the snapshots of the shards of a corpus are combined by `snapshot_merger`
+		 * \param path the path of the snapshot
+		 * @returns `void`
+		 */
+		void save_snapshot(const std::string& path) {
+			const bool qualified = !m_inputs.empty();
+			snapshot_writer<U> writer(path, qualified ? m_inputs : std::vector<std::string>{m_file_path}, qualified);
+			if(m_spill) {
+				m_spill.get()->for_each([&writer](std::string_view word, U freq) {
+						writer.add_word(word, freq);
+						});
+			} else {
+				std::vector<std::pair<std::string_view, U>> entries{};
+				entries.reserve(m_word_freq.size());
+				for(const auto& [word, freq]: m_word_freq) {
+					entries.emplace_back(word, freq);
+				}
+				std::sort(entries.begin(), entries.end(), [](const auto& lhs, const auto& rhs) {
+						return lhs.first < rhs.first;
+						});
+				for(const auto& [word, freq]: entries) {
+					writer.add_word(word, freq);
+				}
+			}
+			smileys_map all = all_smileys();
+			std::vector<std::pair<std::string_view, libs::datastructure::position_list<U>*>> smileys{};
+			for(auto& [code, positions]: all) {
+				positions.sort();
+				smileys.emplace_back(code, &positions);
+			}
+			std::sort(smileys.begin(), smileys.end(), [](const auto& lhs, const auto& rhs) {
+					return lhs.first < rhs.first;
+					});
+			for(const auto& [code, positions]: smileys) {
+				writer.add_smiley(code, positions->to_vector());
+			}
+			writer.close();
+		}
 		/**
 		 * Sets input file path
 		 * \param file_path the path of input file
@@ -247,7 +1061,7 @@ class io_engine {
 		 */
 		void set_file_path(const std::string& file_path) {
 #if !defined(_TEST_)
-			if(!std::filesystem::exists(file_path)) {
+			if(file_path != stdin_path && !std::filesystem::exists(file_path)) {
 				std::error_code ec;
 				throw std::filesystem::filesystem_error("Cant' find file " + file_path, 
 						std::move(file_path), ec);
@@ -262,14 +1076,407 @@ class io_engine {
 		std::string get_file_path() const {
 			return m_file_path;
 		}
+		/**
+		 * Sets the way the input file is read
+		 * \param reader the reader type
+		 * @returns `void`
+		 */
+		void set_reader(reader_type reader) {
+			m_reader = reader;
+		}
+		/**
+		 * Lets the engine tune the size of the chunks at runtime instead of using the fixed block size
+		 * \param adaptive whether the size is tuned
+		 * @returns `void`
+		 */
+		void set_adaptive_block_size(bool adaptive) {
+			m_adaptive_block_size = adaptive;
+			if(!adaptive) {
+				m_chunk_sizer.reset();
+			}
+		}
+		/**
+		 * Gets the size of the chunks, i.e. the last size chosen by the adaptive mode or the fixed block size
+		 * @returns `size_t`
+		 */
+		size_t get_block_size() const {
+			return m_chunk_sizer ? m_chunk_sizer.get()->size() : m_block_size;
+		}
+		/**
+		 * Gets the controller of the adaptive chunk size which tells the range of the chosen sizes
+		 * @returns `const chunk_size_controller*` or `nullptr` if the block size is fixed or nothing has been read yet
+		 */
+		const chunk_size_controller* get_chunk_size_controller() const {
+			return m_chunk_sizer.get();
+		}
+		/**
+		 * Sets the number of the threads of the parallel reader
+		 * \param readers_count the number of the byte ranges read concurrently, `0` means the number of the workers
+		 * @returns `void`
+		 */
+		void set_readers_count(size_t readers_count) {
+			m_readers_count = readers_count;
+		}
+		/**
+		 * Configures the asynchronous reader
+		 * \param backend the preferred way to issue the reads, `pread` is used if io_uring isn't available
+		 * \param queue_depth the number of the reads in flight
+		 * \param direct whether the page cache is bypassed if the file system allows it
+		 * @returns `void`
+		 */
+		void set_async_io(async_backend backend, size_t queue_depth = async_file_reader::default_queue_depth, bool direct = true) {
+			m_async_backend = backend;
+			m_io_depth = std::max<size_t>(queue_depth, 1);
+			m_direct_io = direct;
+		}
+		/**
+		 * Gets the way the reads have been issued by the last asynchronous `read`
+		 * @returns `async_backend` which differs from the configured one if io_uring isn't available
+		 */
+		async_backend get_async_backend() const {
+			return m_async_backend_used;
+		}
+		/**
+		 * Sets the size of the sliding window used by the memory mapped reader
+		 * \param window_size the window size in bytes, it is at least twice of the block size
+		 * @returns `void`
+		 */
+		void set_mapped_window_size(size_t window_size) {
+			m_mapped_window_size = window_size;
+		}
+		/**
+		 * Sets the emoticons to search for
+		 * \param set the emoticons
+		 * @returns `void`
+		 */
+		void set_smileys(const libs::utils::smiley_set& set) {
+			m_smiley_set = set;
+		}
+		/**
+		 * Selects the way the chunks are mined
+		 * \param kernel the kernel
+		 * @returns `void`
+		 */
+		void set_kernel(libs::analysis::analysis_kernel kernel) {
+			m_kernel = kernel;
+		}
+		/**
+		 * Selects the way the chunks are handed out to the workers
+		 * \param scheduler the scheduler
+		 * @returns `void`
+		 */
+		void set_scheduler(libs::analysis::scheduler_type scheduler) {
+			m_scheduler = scheduler;
+		}
+		/**
+		 * Gets the per-worker statistics of the work stealing scheduler collected by the last `read`
+		 * @returns `std::vector<libs::safe_datastructure::worker_stats>` which is empty for the shared queue
+		 */
+		const std::vector<libs::safe_datastructure::worker_stats>& get_scheduler_stats() const {
+			return m_scheduler_stats;
+		}
+		/**
+		 * Sets the number of chunks which results are written to the database in a single transaction
+		 * \param chunks the number of chunks, `1` means a transaction per chunk
+		 * @returns `void`
+		 */
+		void set_db_batch_size(size_t chunks) {
+			m_db_batch_size = std::max<size_t>(chunks, 1);
+		}
+		/**
+		 * Keeps the statistics in the database across the runs over an append-only file: a read counts only the complete lines
+		 * appended since the checkpoint and adds them to the counts of the previous runs. Every batch moves the checkpoint by
+		 * the same transaction, so a crashed run resumes from its last committed batch. A rotated or truncated file is read
+		 * from its beginning. The results kept in the ram-memory and the snapshot cover only the part read by this engine.
+		 * Should be set before the first read.
+		 * \param resumable whether the runs are resumed
+		 * @returns `void`
+		 */
+		void set_resumable(bool resumable) {
+			if(resumable && m_db_name.empty()) {
+				throw libs::exception::custom_exception("Error: The checkpoints are kept in the database, its path isn't set");
+			}
+			m_resumable = resumable;
+		}
+		/**
+		 * Gets the offset of the input up to which the statistics are committed to the database by the resumable reads
+		 * @returns `size_t`
+		 */
+		size_t get_checkpoint() const {
+			return m_checkpoint;
+		}
+		/**
+		 * Gets the offset of the input the last resumable or followed read has started at, `0` if the input was read from its beginning
+		 * @returns `size_t`
+		 */
+		size_t get_resumed_from() const {
+			return m_resumed_from;
+		}
+		/**
+		 * Keeps the n most frequent words up to date while the words are counted, so `query_n_most_frequent` of at most n words
+		 * doesn't scan all the counts. It is dropped once the counts are spilled, they are ranked when queried then.
+		 * Should be set before the first read.
+		 * \param n the number of the words kept
+		 * @returns `void`
+		 */
+		void track_top_n(size_t n) {
+			m_top_tracker = std::make_unique<libs::datastructure::top_n_tracker<U>>(n);
+		}
+		/**
+		 * Follows the input file like `tail -f`: the complete lines appended to it are counted as soon as they are written and
+		 * added to the statistics read so far. The file is watched by inotify where it is available, otherwise it is polled.
+		 * A rotated or truncated file is followed from its beginning with the statistics started over.
+		 * \param on_update the callback invoked after every check of the file, at least once per `poll_interval`,
+		 * e.g. to report the statistics, it returns `false` to stop following
+		 * \param poll_interval the longest time between two checks of the file
+		 * @returns `void`
+		 */
+		void follow(const std::function<bool()>& on_update, std::chrono::milliseconds poll_interval = std::chrono::milliseconds(100)) {
+			if(!m_inputs.empty() || is_streamed() || peek_compression() != compression_type::none) {
+				throw libs::exception::custom_exception("Error: Only a single regular uncompressed file can be followed");
+			}
+			file_watcher watcher(m_file_path);
+			// the head counted so far is hashed, so a file truncated and written again in place is told apart
+			file_identity identity = file_identity::of(m_file_path, std::min(m_checkpoint, file_identity::head_limit));
+			auto identify = [this](size_t head_size) -> std::optional<file_identity> {
+				try {
+					return file_identity::of(m_file_path, head_size);
+				} catch(const libs::exception::custom_exception&) {
+					return std::nullopt;
+				}
+			};
+			size_t seen_size = 0;
+			m_following = true;
+			try {
+				do {
+					std::error_code ec;
+					const size_t size = std::filesystem::file_size(m_file_path, ec);
+					if(ec || !std::filesystem::exists(m_file_path)) {
+						// the file is being rotated
+						continue;
+					}
+					const std::optional<file_identity> current = identify(identity.head_size);
+					if(!current) {
+						// the file has been removed since its size was got
+						continue;
+					}
+					if(*current != identity || size < m_checkpoint) {
+						identity = *current;
+						watcher.rewatch();
+						restart_following();
+						seen_size = 0;
+					}
+					// the line being appended is read once it grows
+					if(size > m_checkpoint && size != seen_size) {
+						read();
+					}
+					seen_size = size;
+					if(identity.head_size < std::min(m_checkpoint, file_identity::head_limit)) {
+						if(const std::optional<file_identity> counted = identify(std::min(m_checkpoint, file_identity::head_limit))) {
+							identity = *counted;
+						}
+					}
+				} while(on_update() && (watcher.wait(poll_interval), true));
+			} catch(...) {
+				m_following = false;
+				throw;
+			}
+			m_following = false;
+		}
+		/**
+		 * Switches the word counting to the external aggregation: the workers spill their tables as sorted runs
+		 * and the positions of their smileys once the memory budget is hit, the runs are merged when the results are queried.
+		 * \param spill_dir the directory of the temporary runs, it is created if it doesn't exist
+		 * \param memory_budget the memory budget of all the workers' tables in bytes
+		 * @returns `void`
+		 */
+		void set_spill(const std::string& spill_dir, size_t memory_budget) {
+			m_spill = std::make_unique<spill_aggregator<T, U>>(spill_dir);
+			m_memory_budget = memory_budget;
+		}
+		/**
+		 * Gets the number of the runs of the words and of the smileys spilled so far
+		 * @returns `size_t`
+		 */
+		size_t get_spilled_runs_count() const {
+			return m_spill ? m_spill.get()->runs_count() + m_spill.get()->smiley_runs_count() : 0;
+		}
+		/**
+		 * Sets a hard memory budget of the word counts and the smileys: the counting starts in the ram-memory and
+		 * falls back to the external aggregation, see `set_spill`, only once the budget is exceeded. So the inputs of
+		 * every size can be analyzed by the same configuration and the small ones never touch the disk.
+		 * The workers' tables are kept under half of the limit as merging them takes about as much again.
+		 * \param memory_limit the budget in bytes, `0` turns the limit off
+		 * \param spill_dir the directory of the runs if the budget is exceeded, the temporary directory by default
+		 * @returns `void`
+		 */
+		void set_memory_limit(size_t memory_limit, const std::string& spill_dir = "") {
+			m_memory_limit = memory_limit;
+			m_spill_dir = spill_dir;
+			if(!m_spill) {
+				m_memory_budget = memory_limit / 2;
+			}
+		}
+		/**
+		 * Gets the peak footprint of the word counts and the smileys tracked under the memory limit
+		 * @returns `size_t` the number of the bytes, `0` if there is no limit
+		 */
+		size_t get_peak_footprint() const {
+			return m_peak_footprint;
+		}
+		/**
+		 * Checks whether the word counts are kept on the disk, i.e. the spilling is set or the memory limit has been exceeded
+		 * @returns `bool`
+		 */
+		bool is_out_of_core() const {
+			return m_spill != nullptr;
+		}
+		/**
+		 * Sets several input files which are read into the same statistics, every file is read forward by a single thread
+		 * and the files are read concurrently. The smiley positions are qualified by the file, e.g. `logs/a.log:42`.
+		 * \param file_paths the paths of the files, see `libs::utils::expand_input_paths` for the directories and the patterns
+		 * @returns `void`
+		 */
+		void set_inputs(const std::vector<std::string>& file_paths) {
+			static_assert(sizeof(U) * 8 > libs::utils::input_offset_bits, "The position type is too narrow for several input files");
+			if(file_paths.empty()) {
+				throw libs::exception::custom_exception("Error: No input files");
+			}
+			// two readers would take the bytes of the standard input from each other
+			if(std::count(file_paths.begin(), file_paths.end(), stdin_path) > 1) {
+				throw libs::exception::custom_exception("Error: The standard input can be read only once");
+			}
+			for(const auto& path: file_paths) {
+				if(path != stdin_path && !std::filesystem::exists(path)) {
+					std::error_code ec;
+					throw std::filesystem::filesystem_error("Cant' find file " + path, path, ec);
+				}
+			}
+			m_inputs = file_paths;
+			m_file_path = file_paths.front();
+		}
+		/**
+		 * Gets the input files set by `set_inputs`
+		 * @returns `const std::vector<std::string>&`
+		 */
+		const std::vector<std::string>& get_inputs() const {
+			return m_inputs;
+		}
+		/**
+		 * Splits the position of a smiley of several input files
+		 * \param pos the position as it is kept by `get_smileys_map`
+		 * @returns `std::pair<size_t, U>` the index of the file in `get_inputs` and the position in the file
+		 */
+		std::pair<size_t, U> split_position(U pos) const {
+			if(m_inputs.empty()) {
+				return std::make_pair(0, pos);
+			}
+			return std::make_pair(static_cast<size_t>(pos >> libs::utils::input_offset_bits), pos & ((U(1) << libs::utils::input_offset_bits) - 1));
+		}
+		/**
+		 * Checks whether the input can be read only forward, i.e. it is the standard input, a pipe, a socket or a character device
+		 * @returns `bool`
+		 */
+		bool is_streamed() const {
+			std::error_code ec;
+			return m_file_path == stdin_path || !std::filesystem::is_regular_file(m_file_path, ec);
+		}
+		/**
+		 * Gets the compression of the input detected by the last `read`
+		 * @returns `compression_type`
+		 */
+		compression_type get_compression() const {
+			return m_compression;
+		}
+		/**
+		 * Gets the way the input file is read
+		 * @returns `reader_type`
+		 */
+		reader_type get_reader() const {
+			return m_reader;
+		}
+		/**
+		 * Gets the number of worker threads
+		 * @returns `size_t`
+		 */
+		size_t get_workers_count() const {
+			return m_workers_count;
+		}
+		/**
+		 * Turns the instrumentation of the pipeline on or off, the stages of the following `read` calls are recorded into the profile
+		 * \param enabled whether the pipeline is profiled, turning it off drops the collected profile
+		 * @returns `void`
+		 */
+		void set_profiling(bool enabled) {
+			if(!enabled) {
+				m_profile.reset();
+			} else if(!m_profile) {
+				m_profile = std::make_unique<libs::analysis::pipeline_profile>();
+			}
+		}
+		/**
+		 * Gets the profile of the pipeline, the caller may time its own stages into it, e.g. the report
+		 * @returns `libs::analysis::pipeline_profile*` or `nullptr` if the profiling is off
+		 */
+		libs::analysis::pipeline_profile* get_profile() {
+			return m_profile.get();
+		}
 	private:
+		/// The number of chunks which can be queued per worker before the reader blocks
+		static constexpr size_t pending_tasks_per_worker = 4;
 		mutable std::string m_file_path{};
 		size_t m_block_size{};
-		std::unique_ptr<libs::safe_datastructure::task_queue<T, U>> m_queue;
+		size_t m_workers_count{};
+		reader_type m_reader{reader_type::stream};
+		reader_type m_reader_used{reader_type::stream};
+		size_t m_mapped_window_size{64 * 1024 * 1024};
+		size_t m_readers_count{0};
+		async_backend m_async_backend{async_backend::io_uring};
+		async_backend m_async_backend_used{async_backend::io_uring};
+		size_t m_io_depth{async_file_reader::default_queue_depth};
+		bool m_direct_io{true};
+		compression_type m_compression{compression_type::none};
+		std::vector<std::string> m_inputs{};
+		bool m_adaptive_block_size{false};
+		std::unique_ptr<chunk_size_controller> m_chunk_sizer{};
+		libs::utils::smiley_set m_smiley_set{libs::utils::smiley_set::defaults()};
+		libs::analysis::analysis_kernel m_kernel{libs::analysis::analysis_kernel::split};
+		libs::analysis::scheduler_type m_scheduler{libs::analysis::scheduler_type::shared_queue};
+		std::vector<libs::safe_datastructure::worker_stats> m_scheduler_stats{};
+		std::unique_ptr<queue_type> m_queue;
 		const std::string m_db_name;
 		std::unique_ptr<libs::db::db_engine> m_db;
-		std::unordered_map<T, U> m_word_freq{};
-		std::unordered_map<T, std::vector<U>> m_smileys{};
+		std::unique_ptr<libs::db::statement> m_upsert_word;
+		std::unique_ptr<libs::db::statement> m_insert_smiley;
+		std::unique_ptr<libs::db::statement> m_update_checkpoint;
+		bool m_resumable{false};
+		bool m_tables_ready{false};
+		std::string m_checkpoint_path{};
+		/// The offset of the input up to which the statistics are committed to the database
+		size_t m_checkpoint{0};
+		size_t m_resumed_from{0};
+		bool m_following{false};
+		/// The end of the part of the input being read by a resumable or followed read
+		size_t m_tail_end{0};
+		std::unique_ptr<libs::datastructure::top_n_tracker<U>> m_top_tracker{};
+		std::mutex m_db_mtx;
+		std::mutex m_db_write_mtx;
+		size_t m_db_batch_size{16};
+		size_t m_pending_chunks{0};
+		counter_type m_pending_word_freq{};
+		smileys_map m_pending_smileys{};
+		/// The end of the contiguous chunks merged into the pending batch
+		size_t m_pending_end{0};
+		std::map<size_t, early_chunk> m_early_chunks{};
+		std::unique_ptr<spill_aggregator<T, U>> m_spill{};
+		size_t m_memory_budget{0};
+		size_t m_memory_limit{0};
+		size_t m_peak_footprint{0};
+		std::string m_spill_dir{};
+		std::mutex m_spill_mtx;
+		counter_type m_word_freq{};
+		smileys_map m_smileys{};
+		std::unique_ptr<libs::analysis::pipeline_profile> m_profile{};
 };
 }
 }
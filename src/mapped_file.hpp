@@ -0,0 +1,153 @@
+#ifndef __MAPPED_FILE_HPP__
+#define __MAPPED_FILE_HPP__
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#if defined(_UNIX_) || defined(__unix__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "exception.hpp"
+
+namespace libs {
+	namespace proccesing {
+/**
+ * \brief Read-only memory mapping of a file which is mapped by sliding windows,
+ * so files bigger than the address space/ram-memory can be processed too.
+ */
+class mapped_file {
+	public:
+		/**
+		 * \brief A mapped region of the file, the region is unmapped as soon as the last reference to it is released
+		 */
+		class window {
+			private:
+				void* m_addr{nullptr};
+				size_t m_map_length{};
+				size_t m_offset{};
+				std::string_view m_data{};
+			public:
+				/**
+				 * Constructor with arguments
+				 * \param addr the page aligned address returned by `mmap`
+				 * \param map_length the length of the mapping
+				 * \param offset the file offset of the first byte of `data`
+				 * \param data the requested bytes of the file
+				 */
+				window(void* addr, size_t map_length, size_t offset, std::string_view data): 
+					m_addr(addr), 
+					m_map_length(map_length), 
+					m_offset(offset), 
+					m_data(data) {}
+				/**
+				 * Destructor unmaps the region
+				 */
+				~window() {
+#if defined(_UNIX_) || defined(__unix__)
+					if(m_addr != nullptr) {
+						munmap(m_addr, m_map_length);
+					}
+#endif
+				}
+				window(const window&) = delete;
+				window& operator=(const window&) = delete;
+				/**
+				 * Gets the file offset of the first byte of the window
+				 * @returns `size_t`
+				 */
+				size_t offset() const {
+					return m_offset;
+				}
+				/**
+				 * Gets the mapped bytes
+				 * @returns `std::string_view`
+				 */
+				std::string_view data() const {
+					return m_data;
+				}
+		};
+	private:
+		int m_fd{-1};
+		size_t m_size{};
+		size_t m_page_size{4096};
+	public:
+		/**
+		 * Constructor with an argument, opens the file
+		 * \param file_path the path of the file
+		 */
+		explicit mapped_file(const std::string& file_path) {
+#if defined(_UNIX_) || defined(__unix__)
+			m_fd = ::open(file_path.c_str(), O_RDONLY);
+			if(m_fd < 0) {
+				const std::string err_msg("Error: Can't open file: " + file_path);
+				throw libs::exception::custom_exception(err_msg.c_str());
+			}
+			struct stat st{};
+			if(fstat(m_fd, &st) != 0) {
+				::close(m_fd);
+				const std::string err_msg("Error: Can't stat file: " + file_path);
+				throw libs::exception::custom_exception(err_msg.c_str());
+			}
+			m_size = st.st_size;
+			m_page_size = sysconf(_SC_PAGESIZE);
+#else
+			throw libs::exception::custom_exception("Error: Memory mapped input isn't supported on this platform");
+#endif
+		}
+		/**
+		 * Destructor closes the file, the windows which are still alive remain valid
+		 */
+		~mapped_file() {
+#if defined(_UNIX_) || defined(__unix__)
+			if(m_fd >= 0) {
+				::close(m_fd);
+			}
+#endif
+		}
+		mapped_file(const mapped_file&) = delete;
+		mapped_file& operator=(const mapped_file&) = delete;
+		/**
+		 * Gets the file size
+		 * @returns `size_t`
+		 */
+		size_t size() const {
+			return m_size;
+		}
+		/**
+		 * Maps the region of the file and advises the kernel that it is going to be read sequentially
+		 * \param offset the file offset of the region, doesn't have to be page aligned
+		 * \param length the length of the region, it is truncated by the end of the file
+		 * @returns `std::shared_ptr<const window>`
+		 */
+		std::shared_ptr<const window> map(size_t offset, size_t length) const {
+			offset = std::min(offset, m_size);
+			length = std::min(length, m_size - offset);
+			if(length == 0) {
+				return std::make_shared<const window>(nullptr, 0, offset, std::string_view{});
+			}
+#if defined(_UNIX_) || defined(__unix__)
+			const size_t aligned = offset - offset % m_page_size;
+			const size_t map_length = length + (offset - aligned);
+			void* addr = mmap(nullptr, map_length, PROT_READ, MAP_PRIVATE, m_fd, aligned);
+			if(addr == MAP_FAILED) {
+				throw libs::exception::custom_exception("Error: Can't map the input file");
+			}
+			madvise(addr, map_length, MADV_SEQUENTIAL);
+			madvise(addr, map_length, MADV_WILLNEED);
+			const char* data = static_cast<const char*>(addr) + (offset - aligned);
+			return std::make_shared<const window>(addr, map_length, offset, std::string_view(data, length));
+#else
+			throw libs::exception::custom_exception("Error: Memory mapped input isn't supported on this platform");
+#endif
+		}
+};
+}
+}
+
+#endif // __MAPPED_FILE_HPP__
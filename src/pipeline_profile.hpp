@@ -0,0 +1,402 @@
+#ifndef __PIPELINE_PROFILE_HPP__
+#define __PIPELINE_PROFILE_HPP__
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(_UNIX_) || defined(__unix__)
+#include <sys/resource.h>
+#endif
+
+namespace libs {
+	namespace analysis {
+/**
+ * @brief Defines the stages of the pipeline which are timed by the profile
+ */
+enum class pipeline_stage : size_t {
+	/// The reader threads read and cut the input, the time they are blocked by the full queue isn't included
+	read,
+	/// The reader threads are blocked by the full queue, i.e. the workers are the bottleneck
+	submit_wait,
+	/// The workers scan the chunks for the smileys
+	smileys,
+	/// The workers tokenize and count the words, the fused kernel's single pass is accounted here
+	tokenize,
+	/// The workers' tables are merged into the final statistics
+	merge,
+	/// The batches are upserted into the database
+	db_write,
+	/// The workers' tables are spilled to the disk as sorted runs
+	spill,
+	/// The most frequent words and the smileys are queried from the statistics
+	query,
+	/// The report is generated
+	report,
+	/// The number of the stages
+	count
+};
+/**
+ * Gets the name of the stage as it appears in the profile
+ * \param stage the stage
+ * @returns `const char*`
+ */
+inline const char* stage_name(pipeline_stage stage) {
+	static constexpr std::array<const char*, static_cast<size_t>(pipeline_stage::count)> names{
+		"read", "submit_wait", "smileys", "tokenize", "merge", "db_write", "spill", "query", "report"};
+	return names[static_cast<size_t>(stage)];
+}
+/**
+ * \brief The stage times kept by a single thread without any synchronization, they are added to the profile once the thread is done
+ */
+struct stage_times {
+	std::array<uint64_t, static_cast<size_t>(pipeline_stage::count)> ns{};
+	std::array<uint64_t, static_cast<size_t>(pipeline_stage::count)> calls{};
+	/**
+	 * Adds a measurement
+	 * \param stage the stage
+	 * \param elapsed the duration
+	 * @returns `void`
+	 */
+	void add(pipeline_stage stage, std::chrono::nanoseconds elapsed) {
+		ns[static_cast<size_t>(stage)] += elapsed.count();
+		++calls[static_cast<size_t>(stage)];
+	}
+};
+/**
+ * \brief A lock free histogram over the powers of two, the bucket `i` counts the values in `[2^(i-1), 2^i)` and the bucket `0` the zeros
+ */
+class log2_histogram {
+	public:
+		static constexpr size_t buckets_count = 65;
+	private:
+		std::array<std::atomic<uint64_t>, buckets_count> m_buckets{};
+	public:
+		/**
+		 * Records a value
+		 * \param value the value
+		 * @returns `void`
+		 */
+		void record(uint64_t value) {
+			size_t bucket = 0;
+			for(; value != 0; value >>= 1) {
+				++bucket;
+			}
+			m_buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+		}
+		/**
+		 * Gets the number of the values recorded into the bucket
+		 * \param bucket the bucket index
+		 * @returns `uint64_t`
+		 */
+		uint64_t count(size_t bucket) const {
+			return m_buckets[bucket].load(std::memory_order_relaxed);
+		}
+		/**
+		 * Gets the exclusive upper bound of the bucket's values
+		 * \param bucket the bucket index
+		 * @returns `uint64_t` which saturates for the last bucket
+		 */
+		static uint64_t upper_bound(size_t bucket) {
+			return bucket >= 64 ? UINT64_MAX : uint64_t(1) << bucket;
+		}
+};
+/**
+ * \brief Collects the run profile of the pipeline: the time of every stage summed over the threads, the throughput,
+ * the queue depth and the lock wait histograms and the peak RSS. The counters are relaxed atomics, the hot paths keep
+ * their own `stage_times` and add them once, so the profiling costs a couple of clock reads per chunk.
+ * The profile is dumped as JSON together with the attributes of the run, e.g. the reader and the chunk size.
+ */
+class pipeline_profile {
+	public:
+		using clock = std::chrono::steady_clock;
+		/**
+		 * \brief Measures the lifetime of the object into a stage of the profile
+		 */
+		class scoped_timer {
+			private:
+				pipeline_profile* m_profile{nullptr};
+				pipeline_stage m_stage{pipeline_stage::read};
+				clock::time_point m_start{};
+			public:
+				/**
+				 * Constructor with arguments
+				 * \param profile the profile, nothing is measured if it's `nullptr`
+				 * \param stage the stage
+				 */
+				scoped_timer(pipeline_profile* profile, pipeline_stage stage):
+					m_profile(profile),
+					m_stage(stage) {
+					if(m_profile != nullptr) {
+						m_start = clock::now();
+					}
+				}
+				~scoped_timer() {
+					if(m_profile != nullptr) {
+						m_profile->add(m_stage, clock::now() - m_start);
+					}
+				}
+				scoped_timer(const scoped_timer&) = delete;
+				scoped_timer& operator=(const scoped_timer&) = delete;
+		};
+	private:
+		std::array<std::atomic<uint64_t>, static_cast<size_t>(pipeline_stage::count)> m_ns{};
+		std::array<std::atomic<uint64_t>, static_cast<size_t>(pipeline_stage::count)> m_calls{};
+		std::atomic<uint64_t> m_wall_ns{0};
+		std::atomic<uint64_t> m_bytes{0};
+		std::atomic<uint64_t> m_tokens{0};
+		std::atomic<uint64_t> m_chunks{0};
+		log2_histogram m_queue_depth{};
+		log2_histogram m_lock_wait{};
+		std::vector<std::pair<std::string, std::string>> m_attributes{};
+		std::mutex m_mtx;
+	private:
+		static std::string quote(const std::string& value) {
+			std::string ret("\"");
+			for(const char c: value) {
+				if(c == '"' || c == '\\') {
+					ret.push_back('\\');
+					ret.push_back(c);
+				} else if(static_cast<unsigned char>(c) < 0x20) {
+					char escaped[8];
+					std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+					ret += escaped;
+				} else {
+					ret.push_back(c);
+				}
+			}
+			return ret + "\"";
+		}
+		static double seconds(uint64_t ns) {
+			return static_cast<double>(ns) / 1e9;
+		}
+		static void write_histogram(std::ostream& os, const log2_histogram& histogram) {
+			os << "[";
+			bool first = true;
+			for(size_t bucket = 0; bucket < log2_histogram::buckets_count; ++bucket) {
+				if(histogram.count(bucket) == 0) {
+					continue;
+				}
+				os << (first ? "" : ", ") << "{\"lt\": " << log2_histogram::upper_bound(bucket) << ", \"count\": " << histogram.count(bucket) << "}";
+				first = false;
+			}
+			os << "]";
+		}
+	public:
+		pipeline_profile() = default;
+		pipeline_profile(const pipeline_profile&) = delete;
+		pipeline_profile& operator=(const pipeline_profile&) = delete;
+		/**
+		 * Adds a measurement of the stage
+		 * \param stage the stage
+		 * \param elapsed the duration
+		 * @returns `void`
+		 */
+		void add(pipeline_stage stage, std::chrono::nanoseconds elapsed) {
+			m_ns[static_cast<size_t>(stage)].fetch_add(elapsed.count(), std::memory_order_relaxed);
+			m_calls[static_cast<size_t>(stage)].fetch_add(1, std::memory_order_relaxed);
+		}
+		/**
+		 * Adds the measurements of a thread
+		 * \param times the thread's stage times
+		 * @returns `void`
+		 */
+		void add(const stage_times& times) {
+			for(size_t i = 0; i < times.ns.size(); ++i) {
+				m_ns[i].fetch_add(times.ns[i], std::memory_order_relaxed);
+				m_calls[i].fetch_add(times.calls[i], std::memory_order_relaxed);
+			}
+		}
+		/**
+		 * Adds the wall time of a run of the pipeline, the throughput is computed from it
+		 * \param elapsed the duration
+		 * @returns `void`
+		 */
+		void add_wall_time(std::chrono::nanoseconds elapsed) {
+			m_wall_ns.fetch_add(elapsed.count(), std::memory_order_relaxed);
+		}
+		/**
+		 * Adds the processed work
+		 * \param chunks the number of the chunks
+		 * \param bytes the number of the bytes
+		 * \param tokens the number of the words
+		 * @returns `void`
+		 */
+		void add_work(uint64_t chunks, uint64_t bytes, uint64_t tokens) {
+			m_chunks.fetch_add(chunks, std::memory_order_relaxed);
+			m_bytes.fetch_add(bytes, std::memory_order_relaxed);
+			m_tokens.fetch_add(tokens, std::memory_order_relaxed);
+		}
+		/**
+		 * Records the number of the chunks waiting in the queue when a new one is submitted
+		 * \param depth the number of the chunks
+		 * @returns `void`
+		 */
+		void record_queue_depth(size_t depth) {
+			m_queue_depth.record(depth);
+		}
+		/**
+		 * Records the time a thread waited for a lock
+		 * \param elapsed the duration
+		 * @returns `void`
+		 */
+		void record_lock_wait(std::chrono::nanoseconds elapsed) {
+			m_lock_wait.record(elapsed.count());
+		}
+		/**
+		 * Sets a textual attribute of the run, the previous value of the same name is replaced
+		 * \param name the name
+		 * \param value the value
+		 * @returns `void`
+		 */
+		void set_attribute(const std::string& name, const std::string& value) {
+			set_raw_attribute(name, quote(value));
+		}
+		/**
+		 * Sets a numeric attribute of the run, the previous value of the same name is replaced
+		 * \param name the name
+		 * \param value the value
+		 * @returns `void`
+		 */
+		template <typename N, typename = std::enable_if_t<std::is_arithmetic_v<N>>>
+		void set_attribute(const std::string& name, N value) {
+			std::ostringstream os;
+			os << value;
+			set_raw_attribute(name, os.str());
+		}
+		/**
+		 * Sets an attribute of the run whose value is already JSON, e.g. an array
+		 * \param name the name
+		 * \param json the value
+		 * @returns `void`
+		 */
+		void set_raw_attribute(const std::string& name, const std::string& json) {
+			std::lock_guard<std::mutex> lck(m_mtx);
+			for(auto& [key, value]: m_attributes) {
+				if(key == name) {
+					value = json;
+					return;
+				}
+			}
+			m_attributes.emplace_back(name, json);
+		}
+		/**
+		 * Gets the total time of the stage summed over the threads
+		 * \param stage the stage
+		 * @returns `std::chrono::nanoseconds`
+		 */
+		std::chrono::nanoseconds stage_time(pipeline_stage stage) const {
+			return std::chrono::nanoseconds(m_ns[static_cast<size_t>(stage)].load(std::memory_order_relaxed));
+		}
+		/**
+		 * Gets the number of the measurements of the stage
+		 * \param stage the stage
+		 * @returns `uint64_t`
+		 */
+		uint64_t stage_calls(pipeline_stage stage) const {
+			return m_calls[static_cast<size_t>(stage)].load(std::memory_order_relaxed);
+		}
+		/**
+		 * Gets the number of the processed bytes
+		 * @returns `uint64_t`
+		 */
+		uint64_t bytes() const {
+			return m_bytes.load(std::memory_order_relaxed);
+		}
+		/**
+		 * Gets the number of the processed words
+		 * @returns `uint64_t`
+		 */
+		uint64_t tokens() const {
+			return m_tokens.load(std::memory_order_relaxed);
+		}
+		/**
+		 * Gets the number of the processed chunks
+		 * @returns `uint64_t`
+		 */
+		uint64_t chunks() const {
+			return m_chunks.load(std::memory_order_relaxed);
+		}
+		/**
+		 * Gets the histogram of the queue depth
+		 * @returns `const log2_histogram&`
+		 */
+		const log2_histogram& queue_depth() const {
+			return m_queue_depth;
+		}
+		/**
+		 * Gets the histogram of the lock waits in nanoseconds
+		 * @returns `const log2_histogram&`
+		 */
+		const log2_histogram& lock_wait() const {
+			return m_lock_wait;
+		}
+		/**
+		 * Gets the peak resident set size of the process
+		 * @returns `size_t` the number of the bytes, `0` if the platform doesn't tell
+		 */
+		static size_t peak_rss() {
+#if defined(_UNIX_) || defined(__unix__)
+			struct rusage usage{};
+			if(getrusage(RUSAGE_SELF, &usage) == 0) {
+				// kilobytes on Linux
+				return static_cast<size_t>(usage.ru_maxrss) * 1024;
+			}
+#endif
+			return 0;
+		}
+		/**
+		 * Formats the profile as a JSON object
+		 * @returns `std::string`
+		 */
+		std::string to_json() {
+			const uint64_t wall_ns = m_wall_ns.load(std::memory_order_relaxed);
+			const double wall = seconds(wall_ns);
+			std::ostringstream os;
+			os.precision(9);
+			os << "{\n";
+			os << "  \"wall_seconds\": " << wall << ",\n";
+			os << "  \"bytes\": " << bytes() << ",\n";
+			os << "  \"tokens\": " << tokens() << ",\n";
+			os << "  \"chunks\": " << chunks() << ",\n";
+			os << "  \"bytes_per_second\": " << (wall_ns == 0 ? 0.0 : bytes() / wall) << ",\n";
+			os << "  \"tokens_per_second\": " << (wall_ns == 0 ? 0.0 : tokens() / wall) << ",\n";
+			os << "  \"peak_rss_bytes\": " << peak_rss() << ",\n";
+			os << "  \"stages\": {";
+			for(size_t i = 0; i < static_cast<size_t>(pipeline_stage::count); ++i) {
+				const pipeline_stage stage = static_cast<pipeline_stage>(i);
+				uint64_t ns = stage_time(stage).count();
+				if(stage == pipeline_stage::read) {
+					// the reader spans include the time the readers were blocked by the full queue
+					const uint64_t blocked = stage_time(pipeline_stage::submit_wait).count();
+					ns = ns > blocked ? ns - blocked : 0;
+				}
+				os << (i == 0 ? "\n" : ",\n") << "    " << quote(stage_name(stage)) << ": {\"seconds\": " << seconds(ns) <<
+					", \"calls\": " << stage_calls(stage) << "}";
+			}
+			os << "\n  },\n";
+			os << "  \"queue_depth\": ";
+			write_histogram(os, m_queue_depth);
+			os << ",\n  \"lock_wait_ns\": ";
+			write_histogram(os, m_lock_wait);
+			os << ",\n  \"run\": {";
+			std::lock_guard<std::mutex> lck(m_mtx);
+			for(size_t i = 0; i < m_attributes.size(); ++i) {
+				os << (i == 0 ? "\n" : ",\n") << "    " << quote(m_attributes[i].first) << ": " << m_attributes[i].second;
+			}
+			os << (m_attributes.empty() ? "}" : "\n  }") << "\n}\n";
+			return os.str();
+		}
+};
+}
+}
+
+#endif // __PIPELINE_PROFILE_HPP__
@@ -0,0 +1,214 @@
+#ifndef __POSITION_LIST_HPP__
+#define __POSITION_LIST_HPP__
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "exception.hpp"
+
+namespace libs {
+	namespace datastructure {
+/**
+ * \brief Compact list of the positions: every position is kept as the difference from the previous one, zigzag and varint encoded.
+ * The positions of a chunk are close to each other, so a position takes one or two bytes instead of eight.
+ * The differences may be negative, so the lists of several chunks can be appended in any order, an append copies
+ * the other list's bytes and re-encodes only its first position.
+ * \tparam U the position type
+ */
+template <typename U>
+class position_list {
+	static_assert(std::is_integral<U>::value && sizeof(U) <= sizeof(uint64_t), "The position type must be an integer of at most 64 bits");
+	private:
+		std::string m_bytes{};
+		size_t m_size{0};
+		U m_last{0};
+		bool m_sorted{true};
+	private:
+		static void put_varint(std::string& bytes, uint64_t value) {
+			while(value >= 0x80) {
+				bytes.push_back(static_cast<char>((value & 0x7f) | 0x80));
+				value >>= 7;
+			}
+			bytes.push_back(static_cast<char>(value));
+		}
+		static uint64_t get_varint(const char*& cur, const char* end) {
+			uint64_t value = 0;
+			for(unsigned shift = 0; shift < 64; shift += 7) {
+				if(cur == end) {
+					throw libs::exception::custom_exception("Error: Truncated position list");
+				}
+				const uint8_t byte = static_cast<uint8_t>(*cur++);
+				value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+				if((byte & 0x80) == 0) {
+					return value;
+				}
+			}
+			throw libs::exception::custom_exception("Error: Corrupted position list");
+		}
+		/*
+		 * The difference wraps around, so it is exact whatever the signedness and the width of the positions are.
+		 */
+		static uint64_t encode_delta(U from, U to) {
+			const int64_t delta = static_cast<int64_t>(static_cast<uint64_t>(to) - static_cast<uint64_t>(from));
+			return (static_cast<uint64_t>(delta) << 1) ^ static_cast<uint64_t>(delta >> 63);
+		}
+		static U decode_delta(U from, uint64_t zigzag) {
+			const uint64_t delta = (zigzag >> 1) ^ (~(zigzag & 1) + 1);
+			return static_cast<U>(static_cast<uint64_t>(from) + delta);
+		}
+	public:
+		position_list() = default;
+		/**
+		 * Constructor with an argument
+		 * \param positions the positions in any order
+		 */
+		explicit position_list(const std::vector<U>& positions) {
+			for(const U pos: positions) {
+				push_back(pos);
+			}
+		}
+		/**
+		 * Appends a position
+		 * \param pos the position
+		 * @returns `void`
+		 */
+		void push_back(U pos) {
+			if(m_size != 0 && pos < m_last) {
+				m_sorted = false;
+			}
+			put_varint(m_bytes, encode_delta(m_last, pos));
+			m_last = pos;
+			++m_size;
+		}
+		/**
+		 * Appends the positions of the other list
+		 * \param other the list
+		 * @returns `void`
+		 */
+		void append(const position_list& other) {
+			if(other.m_size == 0) {
+				return;
+			}
+			const char* cur = other.m_bytes.data();
+			const U first = decode_delta(0, get_varint(cur, other.m_bytes.data() + other.m_bytes.size()));
+			if(m_size != 0 && first < m_last) {
+				m_sorted = false;
+			}
+			m_sorted = m_sorted && other.m_sorted;
+			put_varint(m_bytes, encode_delta(m_last, first));
+			m_bytes.append(cur, other.m_bytes.data() + other.m_bytes.size());
+			m_size += other.m_size;
+			m_last = other.m_last;
+		}
+		/**
+		 * Calls the function for every position in the order they were added
+		 * \param fn the callable taking the position
+		 * @returns `void`
+		 */
+		template <typename F>
+		void for_each(F&& fn) const {
+			const char* cur = m_bytes.data();
+			const char* end = cur + m_bytes.size();
+			U pos = 0;
+			while(cur != end) {
+				pos = decode_delta(pos, get_varint(cur, end));
+				fn(pos);
+			}
+		}
+		/**
+		 * Decodes the positions
+		 * @returns `std::vector<U>` in the order they were added
+		 */
+		std::vector<U> to_vector() const {
+			std::vector<U> ret{};
+			ret.reserve(m_size);
+			for_each([&ret](U pos) {
+					ret.push_back(pos);
+					});
+			return ret;
+		}
+		/**
+		 * Sorts the positions ascending, so every difference is non-negative and the list is the most compact
+		 * @returns `void`
+		 */
+		void sort() {
+			if(m_sorted) {
+				return;
+			}
+			std::vector<U> positions = to_vector();
+			std::sort(positions.begin(), positions.end());
+			*this = position_list(positions);
+		}
+		/**
+		 * Gets the encoded positions, e.g. to store them as a blob
+		 * @returns `std::string_view`
+		 */
+		std::string_view bytes() const {
+			return m_bytes;
+		}
+		/**
+		 * Decodes a list from the bytes got by `bytes`
+		 * \param bytes the encoded positions
+		 * @returns `position_list`
+		 */
+		static position_list from_bytes(std::string_view bytes) {
+			position_list ret{};
+			const char* cur = bytes.data();
+			const char* end = cur + bytes.size();
+			while(cur != end) {
+				const U pos = decode_delta(ret.m_last, get_varint(cur, end));
+				if(ret.m_size != 0 && pos < ret.m_last) {
+					ret.m_sorted = false;
+				}
+				ret.m_last = pos;
+				++ret.m_size;
+			}
+			ret.m_bytes.assign(bytes.data(), bytes.size());
+			return ret;
+		}
+		/**
+		 * Gets the number of the positions
+		 * @returns `size_t`
+		 */
+		size_t size() const {
+			return m_size;
+		}
+		/**
+		 * Checks whether the list is empty
+		 * @returns `bool`
+		 */
+		bool empty() const {
+			return m_size == 0;
+		}
+		/**
+		 * Gets the approximate memory footprint of the list
+		 * @returns `size_t` the number of bytes
+		 */
+		size_t memory_usage() const {
+			return m_bytes.capacity();
+		}
+		/**
+		 * Removes all the positions
+		 * @returns `void`
+		 */
+		void clear() {
+			std::string().swap(m_bytes);
+			m_size = 0;
+			m_last = 0;
+			m_sorted = true;
+		}
+		bool operator==(const position_list& other) const {
+			return m_size == other.m_size && m_bytes == other.m_bytes;
+		}
+		bool operator!=(const position_list& other) const {
+			return !(*this == other);
+		}
+};
+}
+}
+
+#endif // __POSITION_LIST_HPP__
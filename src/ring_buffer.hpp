@@ -0,0 +1,281 @@
+#ifndef __RING_BUFFER_HPP__
+#define __RING_BUFFER_HPP__
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <thread>
+#include <tuple>
+#include <utility>
+
+namespace libs {
+	namespace safe_datastructure {
+
+/**
+ * \brief Bounded multi-producer/multi-consumer queue of the pending tasks.
+ * The tasks are stored in place in a ring of cells, every cell carries a sequence number which tells
+ * the producers and the consumers whose turn it is, so the fast path takes no locks (D. Vyukov's design).
+ * The blocking variants spin for a while and then sleep until the opposite side signals them.
+ * \tparam T the type of the task's payload
+ * \tparam U the type of the task's global position and length
+ */
+template <typename T, typename U>
+class mpmc_ring_buffer
+{
+	public:
+		using value_type = std::tuple<T, U, U>;
+		/// The capacity of the default constructed queue
+		static constexpr size_t default_capacity = 1024;
+	private:
+		/// The number of the failed attempts before a blocking call goes to sleep
+		static constexpr size_t spin_count = 64;
+		struct alignas(64) cell {
+			std::atomic<size_t> sequence{0};
+			alignas(value_type) unsigned char storage[sizeof(value_type)];
+			value_type* value() {
+				return std::launder(reinterpret_cast<value_type*>(storage));
+			}
+		};
+		std::unique_ptr<cell[]> m_cells;
+		size_t m_mask{0};
+		alignas(64) std::atomic<size_t> m_enqueue_pos{0};
+		alignas(64) std::atomic<size_t> m_dequeue_pos{0};
+		alignas(64) std::atomic<bool> m_closed{false};
+		std::atomic<size_t> m_waiting_consumers{0};
+		std::atomic<size_t> m_waiting_producers{0};
+		std::mutex m_mtx;
+		std::condition_variable m_not_empty;
+		std::condition_variable m_not_full;
+	private:
+		static size_t round_up_capacity(size_t capacity) {
+			size_t ret = 2;
+			while(ret < capacity) {
+				ret <<= 1;
+			}
+			return ret;
+		}
+		/*
+		 * Wakes up a sleeping side, the fence orders the publication of the cell before reading the number of the sleepers.
+		 */
+		void signal(std::atomic<size_t>& waiting, std::condition_variable& cnd) {
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if(waiting.load(std::memory_order_relaxed) != 0) {
+				std::lock_guard<std::mutex> lck(m_mtx);
+				cnd.notify_all();
+			}
+		}
+		/*
+		 * Claims the cell at the enqueue position and publishes the task in it, the task is moved only on success.
+		 */
+		bool enqueue(value_type&& t) {
+			size_t pos = m_enqueue_pos.load(std::memory_order_relaxed);
+			cell* c = nullptr;
+			while(true) {
+				c = &m_cells[pos & m_mask];
+				const size_t seq = c->sequence.load(std::memory_order_acquire);
+				const std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+				if(diff == 0) {
+					if(m_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+						break;
+					}
+				} else if(diff < 0) {
+					return false;
+				} else {
+					pos = m_enqueue_pos.load(std::memory_order_relaxed);
+				}
+			}
+			new (c->storage) value_type(std::move(t));
+			c->sequence.store(pos + 1, std::memory_order_release);
+			return true;
+		}
+		/*
+		 * Claims the cell at the dequeue position and releases it for the producers of the next lap.
+		 */
+		std::optional<value_type> dequeue() {
+			size_t pos = m_dequeue_pos.load(std::memory_order_relaxed);
+			cell* c = nullptr;
+			while(true) {
+				c = &m_cells[pos & m_mask];
+				const size_t seq = c->sequence.load(std::memory_order_acquire);
+				const std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+				if(diff == 0) {
+					if(m_dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+						break;
+					}
+				} else if(diff < 0) {
+					return std::nullopt;
+				} else {
+					pos = m_dequeue_pos.load(std::memory_order_relaxed);
+				}
+			}
+			value_type* value = c->value();
+			std::optional<value_type> ret(std::move(*value));
+			value->~value_type();
+			c->sequence.store(pos + m_mask + 1, std::memory_order_release);
+			return ret;
+		}
+	public:
+		/**
+		 * Constructor with an argument
+		 * \param capacity the maximum number of pending tasks, rounded up to a power of two,
+		 *      `push` blocks while the queue is full, `0` means `default_capacity`
+		 */
+		explicit mpmc_ring_buffer(size_t capacity = default_capacity) {
+			const size_t size = round_up_capacity(capacity == 0 ? default_capacity : capacity);
+			m_cells = std::make_unique<cell[]>(size);
+			m_mask = size - 1;
+			for(size_t i = 0; i < size; ++i) {
+				m_cells[i].sequence.store(i, std::memory_order_relaxed);
+			}
+		}
+		/**
+		 * Destructor destroys the tasks which haven't been consumed
+		 */
+		~mpmc_ring_buffer() {
+			while(dequeue()) {
+			}
+		}
+		mpmc_ring_buffer(const mpmc_ring_buffer&) = delete;
+		mpmc_ring_buffer& operator=(const mpmc_ring_buffer&) = delete;
+		/**
+		 * Pushes the task if there is a free cell, never blocks
+		 * \param t the task, it is left untouched if the queue is full
+		 * @returns `bool` `false` if the queue is full
+		 */
+		bool try_push(value_type&& t) {
+			if(!enqueue(std::move(t))) {
+				return false;
+			}
+			signal(m_waiting_consumers, m_not_empty);
+			return true;
+		}
+		/**
+		 * Pops the task if there is any, never blocks
+		 * @returns `std::optional<value_type>` which is empty if the queue is empty
+		 */
+		std::optional<value_type> try_pop() {
+			std::optional<value_type> ret = dequeue();
+			if(ret) {
+				signal(m_waiting_producers, m_not_full);
+			}
+			return ret;
+		}
+		/**
+		 * Pushes the task, blocks while the queue is full
+		 * \param t the task
+		 * @returns `bool` `false` if the queue has been closed and the task is dropped
+		 */
+		bool push(value_type&& t) {
+			for(size_t i = 0; i < spin_count; ++i) {
+				if(m_closed.load(std::memory_order_acquire)) {
+					return false;
+				}
+				if(try_push(std::move(t))) {
+					return true;
+				}
+				std::this_thread::yield();
+			}
+			bool pushed = false;
+			{
+				std::unique_lock<std::mutex> lck(m_mtx);
+				m_waiting_producers.fetch_add(1, std::memory_order_seq_cst);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				m_not_full.wait(lck, [&]{
+						pushed = enqueue(std::move(t));
+						return pushed || m_closed.load(std::memory_order_acquire);
+						});
+				m_waiting_producers.fetch_sub(1, std::memory_order_relaxed);
+			}
+			if(pushed) {
+				signal(m_waiting_consumers, m_not_empty);
+			}
+			return pushed;
+		}
+		/**
+		 * Pops the task, blocks while the queue is empty and not closed
+		 * @returns `std::optional<value_type>` which is empty if the queue is closed and drained
+		 */
+		std::optional<value_type> wait_and_pop() {
+			for(size_t i = 0; i < spin_count; ++i) {
+				if(std::optional<value_type> ret = try_pop()) {
+					return ret;
+				}
+				if(m_closed.load(std::memory_order_acquire)) {
+					return try_pop();
+				}
+				std::this_thread::yield();
+			}
+			std::optional<value_type> ret{};
+			{
+				std::unique_lock<std::mutex> lck(m_mtx);
+				m_waiting_consumers.fetch_add(1, std::memory_order_seq_cst);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				m_not_empty.wait(lck, [&]{
+						ret = dequeue();
+						return ret.has_value() || m_closed.load(std::memory_order_acquire);
+						});
+				m_waiting_consumers.fetch_sub(1, std::memory_order_relaxed);
+			}
+			if(ret) {
+				signal(m_waiting_producers, m_not_full);
+				return ret;
+			}
+			return try_pop();
+		}
+		/**
+		 * Closes the queue: the pending tasks are still handed out, then the consumers get an empty result
+		 * and the blocked producers give up
+		 * @returns `void`
+		 */
+		void close() {
+			std::lock_guard<std::mutex> lck(m_mtx);
+			m_closed.store(true, std::memory_order_release);
+			m_not_empty.notify_all();
+			m_not_full.notify_all();
+		}
+		/**
+		 * Reopens the closed queue, so it can be reused for the next batch of tasks
+		 * @returns `void`
+		 */
+		void reopen() {
+			std::lock_guard<std::mutex> lck(m_mtx);
+			m_closed.store(false, std::memory_order_release);
+		}
+		/**
+		 * Checks whether the queue is closed
+		 * @returns `bool`
+		 */
+		bool is_closed() const {
+			return m_closed.load(std::memory_order_acquire);
+		}
+		/**
+		 * Gets the approximate number of the pending tasks
+		 * @returns `size_t`
+		 */
+		size_t size() const {
+			const size_t dequeued = m_dequeue_pos.load(std::memory_order_acquire);
+			const size_t enqueued = m_enqueue_pos.load(std::memory_order_acquire);
+			return enqueued > dequeued ? enqueued - dequeued : 0;
+		}
+		/**
+		 * Checks whether the queue is empty
+		 * @returns `bool`
+		 */
+		bool empty() const {
+			return size() == 0;
+		}
+		/**
+		 * Gets the maximum number of the pending tasks
+		 * @returns `size_t`
+		 */
+		size_t capacity() const {
+			return m_mask + 1;
+		}
+};
+}
+}
+#endif // __RING_BUFFER_HPP__
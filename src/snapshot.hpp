@@ -0,0 +1,436 @@
+#ifndef __SNAPSHOT_HPP__
+#define __SNAPSHOT_HPP__
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <queue>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "exception.hpp"
+#include "input_paths.hpp"
+#include "mapped_file.hpp"
+
+namespace libs {
+	namespace proccesing {
+/**
+ * \brief The header of a snapshot file. A snapshot keeps the full word counts and the smiley positions of a run,
+ * so the runs over the shards of a corpus can be merged later. The file is laid out as:
+ * the header, the input file names, the words sorted by the bytes with their counts, the smiley codes sorted by the bytes
+ * with their positions. Every string is stored as its `uint32_t` length followed by the bytes, the numbers are stored
+ * in the byte order of the machine which wrote the snapshot.
+ */
+struct snapshot_header {
+	/// The magic number and the version of the format
+	static constexpr char magic_value[8] = {'A', 'S', 'S', 'N', 'A', 'P', '0', '1'};
+	char magic[8]{};
+	/// The size of the counters and the positions in bytes
+	uint32_t counter_size{0};
+	/// `1` if the positions are qualified by the input file, see `io_engine::split_position`
+	uint32_t qualified{0};
+	uint64_t inputs_count{0};
+	uint64_t words_count{0};
+	uint64_t words_offset{0};
+	uint64_t smileys_count{0};
+	uint64_t smileys_offset{0};
+};
+/**
+ * \brief Writes a snapshot: the words must be added in the ascending order of their bytes, then the smileys in the same order.
+ * \tparam U the type of the counters and the positions, must be trivially copyable
+ */
+template <typename U>
+class snapshot_writer {
+	static_assert(std::is_trivially_copyable<U>::value, "The counter type must be trivially copyable");
+	private:
+		/// The size of the stream buffer
+		static constexpr size_t io_buffer_size = 1 << 20;
+		std::vector<char> m_buffer;
+		std::ofstream m_os{};
+		std::string m_path{};
+		snapshot_header m_header{};
+	private:
+		void write_string(std::string_view str) {
+			const uint32_t length = static_cast<uint32_t>(str.size());
+			m_os.write(reinterpret_cast<const char*>(&length), sizeof(length));
+			m_os.write(str.data(), str.size());
+		}
+	public:
+		/**
+		 * Constructor with arguments, creates the file and writes the input file names
+		 * \param path the path of the snapshot
+		 * \param inputs the names of the input files the positions refer to
+		 * \param qualified whether the positions carry the index of the input file
+		 */
+		snapshot_writer(const std::string& path, const std::vector<std::string>& inputs, bool qualified):
+			m_buffer(io_buffer_size),
+			m_path(path) {
+			m_os.rdbuf()->pubsetbuf(m_buffer.data(), m_buffer.size());
+			m_os.open(path, std::ios::binary | std::ios::trunc);
+			if(!m_os) {
+				const std::string err_msg("Error: Can't create snapshot file: " + path);
+				throw libs::exception::custom_exception(err_msg.c_str());
+			}
+			std::memcpy(m_header.magic, snapshot_header::magic_value, sizeof(m_header.magic));
+			m_header.counter_size = sizeof(U);
+			m_header.qualified = qualified ? 1 : 0;
+			m_header.inputs_count = inputs.size();
+			m_os.write(reinterpret_cast<const char*>(&m_header), sizeof(m_header));
+			for(const auto& input: inputs) {
+				write_string(input);
+			}
+			m_header.words_offset = m_os.tellp();
+		}
+		snapshot_writer(const snapshot_writer&) = delete;
+		snapshot_writer& operator=(const snapshot_writer&) = delete;
+		/**
+		 * Adds a word, the words are added in the ascending order
+		 * \param word the word
+		 * \param count the number of the occurrences
+		 * @returns `void`
+		 */
+		void add_word(std::string_view word, U count) {
+			write_string(word);
+			m_os.write(reinterpret_cast<const char*>(&count), sizeof(count));
+			++m_header.words_count;
+		}
+		/**
+		 * Adds a smiley once all the words are added, the smileys are added in the ascending order
+		 * \param code the smiley
+		 * \param positions the positions of the smiley
+		 * @returns `void`
+		 */
+		void add_smiley(std::string_view code, const std::vector<U>& positions) {
+			if(m_header.smileys_count == 0) {
+				m_header.smileys_offset = m_os.tellp();
+			}
+			write_string(code);
+			const uint64_t count = positions.size();
+			m_os.write(reinterpret_cast<const char*>(&count), sizeof(count));
+			m_os.write(reinterpret_cast<const char*>(positions.data()), positions.size() * sizeof(U));
+			++m_header.smileys_count;
+		}
+		/**
+		 * Writes the final header and closes the file
+		 * @returns `void`
+		 */
+		void close() {
+			if(m_header.smileys_count == 0) {
+				m_header.smileys_offset = m_os.tellp();
+			}
+			m_os.seekp(0);
+			m_os.write(reinterpret_cast<const char*>(&m_header), sizeof(m_header));
+			m_os.close();
+			if(m_os.fail()) {
+				const std::string err_msg("Error: Can't write snapshot file: " + m_path);
+				throw libs::exception::custom_exception(err_msg.c_str());
+			}
+		}
+};
+/**
+ * \brief Reads a memory mapped snapshot, the words are read in place by a cursor.
+ * \tparam U the type of the counters and the positions
+ */
+template <typename U>
+class snapshot_reader {
+	private:
+		mapped_file m_file;
+		std::shared_ptr<const mapped_file::window> m_window{};
+		std::string_view m_data{};
+		snapshot_header m_header{};
+		std::vector<std::string> m_inputs{};
+		size_t m_pos{0};
+		uint64_t m_words_left{0};
+		std::string_view m_word{};
+		U m_count{};
+	private:
+		[[noreturn]] void corrupted() const {
+			throw libs::exception::custom_exception("Error: Corrupted snapshot file");
+		}
+		std::string_view read_string(size_t& pos) const {
+			uint32_t length = 0;
+			if(pos + sizeof(length) > m_data.size()) {
+				corrupted();
+			}
+			std::memcpy(&length, m_data.data() + pos, sizeof(length));
+			pos += sizeof(length);
+			if(pos + length > m_data.size()) {
+				corrupted();
+			}
+			const std::string_view ret = m_data.substr(pos, length);
+			pos += length;
+			return ret;
+		}
+		template <typename V>
+		V read_value(size_t& pos) const {
+			V ret{};
+			if(pos + sizeof(V) > m_data.size()) {
+				corrupted();
+			}
+			std::memcpy(&ret, m_data.data() + pos, sizeof(V));
+			pos += sizeof(V);
+			return ret;
+		}
+	public:
+		/**
+		 * Constructor with an argument, maps the snapshot and checks its header
+		 * \param path the path of the snapshot
+		 */
+		explicit snapshot_reader(const std::string& path): m_file(path) {
+			m_window = m_file.map(0, m_file.size());
+			m_data = m_window.get()->data();
+			if(m_data.size() < sizeof(m_header)) {
+				corrupted();
+			}
+			std::memcpy(&m_header, m_data.data(), sizeof(m_header));
+			if(std::memcmp(m_header.magic, snapshot_header::magic_value, sizeof(m_header.magic)) != 0) {
+				const std::string err_msg("Error: Not a snapshot file: " + path);
+				throw libs::exception::custom_exception(err_msg.c_str());
+			}
+			if(m_header.counter_size != sizeof(U)) {
+				throw libs::exception::custom_exception("Error: The snapshot counters are of a different size");
+			}
+			size_t pos = sizeof(m_header);
+			for(uint64_t i = 0; i < m_header.inputs_count; ++i) {
+				m_inputs.emplace_back(read_string(pos));
+			}
+			if(m_header.words_offset > m_data.size() || m_header.smileys_offset > m_data.size()) {
+				corrupted();
+			}
+			m_pos = m_header.words_offset;
+			m_words_left = m_header.words_count;
+		}
+		snapshot_reader(const snapshot_reader&) = delete;
+		snapshot_reader& operator=(const snapshot_reader&) = delete;
+		/**
+		 * Gets the names of the input files
+		 * @returns `const std::vector<std::string>&`
+		 */
+		const std::vector<std::string>& inputs() const {
+			return m_inputs;
+		}
+		/**
+		 * Checks whether the positions carry the index of the input file
+		 * @returns `bool`
+		 */
+		bool qualified() const {
+			return m_header.qualified != 0;
+		}
+		/**
+		 * Gets the number of the distinct words
+		 * @returns `size_t`
+		 */
+		size_t words_count() const {
+			return m_header.words_count;
+		}
+		/**
+		 * Moves the cursor to the next word
+		 * @returns `bool` `false` if there are no more words
+		 */
+		bool next_word() {
+			if(m_words_left == 0) {
+				return false;
+			}
+			--m_words_left;
+			m_word = read_string(m_pos);
+			m_count = read_value<U>(m_pos);
+			return true;
+		}
+		/**
+		 * Gets the word under the cursor, it stays valid as long as the reader
+		 * @returns `std::string_view`
+		 */
+		std::string_view word() const {
+			return m_word;
+		}
+		/**
+		 * Gets the count of the word under the cursor
+		 * @returns `U`
+		 */
+		U count() const {
+			return m_count;
+		}
+		/**
+		 * Calls the function for every smiley in the ascending order
+		 * \param fn the callable taking the code as `std::string_view` and the positions as `std::vector<U>&&`
+		 * @returns `void`
+		 */
+		template <typename F>
+		void for_each_smiley(F&& fn) const {
+			size_t pos = m_header.smileys_offset;
+			for(uint64_t i = 0; i < m_header.smileys_count; ++i) {
+				const std::string_view code = read_string(pos);
+				const uint64_t count = read_value<uint64_t>(pos);
+				if(count > (m_data.size() - pos) / sizeof(U)) {
+					corrupted();
+				}
+				std::vector<U> positions(count);
+				std::memcpy(positions.data(), m_data.data() + pos, count * sizeof(U));
+				pos += count * sizeof(U);
+				fn(code, std::move(positions));
+			}
+		}
+};
+/**
+ * \brief Combines several snapshots: the words are merged by a k-way merge over the sorted words of the mapped snapshots,
+ * the input files are concatenated, so every smiley position is rebased onto the merged list of the input files.
+ * \tparam U the type of the counters and the positions
+ */
+template <typename U>
+class snapshot_merger {
+	public:
+		/// The positions carry the index of the input file above these bits, the same as the ones of `io_engine`
+		static constexpr size_t input_offset_bits = libs::utils::input_offset_bits;
+	private:
+		std::vector<std::unique_ptr<snapshot_reader<U>>> m_readers{};
+		std::vector<std::string> m_inputs{};
+		std::vector<size_t> m_input_bases{};
+	public:
+		/**
+		 * Constructor with an argument, maps the snapshots
+		 * \param paths the paths of the snapshots
+		 */
+		explicit snapshot_merger(const std::vector<std::string>& paths) {
+			static_assert(sizeof(U) * 8 > input_offset_bits, "The position type is too narrow for several input files");
+			for(const auto& path: paths) {
+				m_readers.push_back(std::make_unique<snapshot_reader<U>>(path));
+				m_input_bases.push_back(m_inputs.size());
+				const auto& inputs = m_readers.back().get()->inputs();
+				m_inputs.insert(m_inputs.end(), inputs.begin(), inputs.end());
+			}
+		}
+		/**
+		 * Gets the input files of all the snapshots
+		 * @returns `const std::vector<std::string>&`
+		 */
+		const std::vector<std::string>& inputs() const {
+			return m_inputs;
+		}
+		/**
+		 * Splits the merged position
+		 * \param pos the position
+		 * @returns `std::pair<size_t, U>` the index of the file in `inputs` and the position in the file
+		 */
+		static std::pair<size_t, U> split_position(U pos) {
+			return std::make_pair(static_cast<size_t>(pos >> input_offset_bits), pos & ((U(1) << input_offset_bits) - 1));
+		}
+		/**
+		 * Calls the function for every word in the ascending order with its total count, should be called once
+		 * \param fn the callable taking the word as `std::string_view` and the count
+		 * @returns `void`
+		 */
+		template <typename F>
+		void for_each_word(F&& fn) {
+			auto greater = [this](size_t lhs, size_t rhs) {
+				const int cmp = m_readers[lhs].get()->word().compare(m_readers[rhs].get()->word());
+				return cmp != 0 ? cmp > 0 : lhs > rhs;
+			};
+			std::priority_queue<size_t, std::vector<size_t>, decltype(greater)> heap(greater);
+			for(size_t i = 0; i < m_readers.size(); ++i) {
+				if(m_readers[i].get()->next_word()) {
+					heap.push(i);
+				}
+			}
+			while(!heap.empty()) {
+				size_t top = heap.top();
+				heap.pop();
+				// the views point into the mappings, so no word is copied
+				const std::string_view word = m_readers[top].get()->word();
+				U count = m_readers[top].get()->count();
+				if(m_readers[top].get()->next_word()) {
+					heap.push(top);
+				}
+				while(!heap.empty() && m_readers[heap.top()].get()->word() == word) {
+					top = heap.top();
+					heap.pop();
+					count += m_readers[top].get()->count();
+					if(m_readers[top].get()->next_word()) {
+						heap.push(top);
+					}
+				}
+				fn(word, count);
+			}
+		}
+		/**
+		 * Gets n most frequent words of the merged snapshots, the words of the equal frequency are ordered alphabetically
+		 * \param n the number of the words
+		 * @returns `std::vector<std::pair<std::string, U>>` ordered by the frequency descending
+		 */
+		std::vector<std::pair<std::string, U>> top_n(size_t n) {
+			std::vector<std::pair<std::string_view, U>> heap{};
+			if(n == 0) {
+				return {};
+			}
+			auto better = [](const std::pair<std::string_view, U>& lhs, const std::pair<std::string_view, U>& rhs) {
+				return lhs.second != rhs.second ? lhs.second > rhs.second : lhs.first < rhs.first;
+			};
+			heap.reserve(n);
+			for_each_word([&heap, &better, n](std::string_view word, U count) {
+					if(heap.size() < n) {
+						heap.emplace_back(word, count);
+						std::push_heap(heap.begin(), heap.end(), better);
+					} else if(count > heap.front().second) {
+						// The words come in the alphabetical order, so a tie never beats the candidate
+						std::pop_heap(heap.begin(), heap.end(), better);
+						heap.back() = std::make_pair(word, count);
+						std::push_heap(heap.begin(), heap.end(), better);
+					}
+					});
+			std::sort_heap(heap.begin(), heap.end(), better);
+			std::vector<std::pair<std::string, U>> ret{};
+			for(const auto& [word, count]: heap) {
+				ret.emplace_back(std::string(word), count);
+			}
+			return ret;
+		}
+		/**
+		 * Gets the smileys of all the snapshots with the positions qualified by the merged input files
+		 * @returns `std::unordered_map<std::string, std::vector<U>>`
+		 */
+		std::unordered_map<std::string, std::vector<U>> smileys() const {
+			std::unordered_map<std::string, std::vector<U>> ret{};
+			for(size_t i = 0; i < m_readers.size(); ++i) {
+				const snapshot_reader<U>& reader = *m_readers[i];
+				const size_t base = m_input_bases[i];
+				reader.for_each_smiley([&ret, &reader, base](std::string_view code, std::vector<U>&& positions) {
+						std::vector<U>& dest = ret[std::string(code)];
+						for(U pos: positions) {
+							const auto [input, local] = reader.qualified() ? split_position(pos) : std::make_pair(size_t(0), pos);
+							dest.push_back((U(base + input) << input_offset_bits) | local);
+						}
+						});
+			}
+			return ret;
+		}
+		/**
+		 * Writes the merged snapshot, so the snapshots can be merged by several levels, should be called instead of `for_each_word`
+		 * \param path the path of the merged snapshot
+		 * @returns `void`
+		 */
+		void write(const std::string& path) {
+			snapshot_writer<U> writer(path, m_inputs, true);
+			for_each_word([&writer](std::string_view word, U count) {
+					writer.add_word(word, count);
+					});
+			auto merged = smileys();
+			std::vector<std::string_view> codes{};
+			for(const auto& [code, positions]: merged) {
+				codes.push_back(code);
+			}
+			std::sort(codes.begin(), codes.end());
+			for(const auto& code: codes) {
+				writer.add_smiley(code, merged[std::string(code)]);
+			}
+			writer.close();
+		}
+};
+}
+}
+
+#endif // __SNAPSHOT_HPP__
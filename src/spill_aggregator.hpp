@@ -0,0 +1,397 @@
+#ifndef __SPILL_AGGREGATOR_HPP__
+#define __SPILL_AGGREGATOR_HPP__
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "exception.hpp"
+#include "flat_counter.hpp"
+#include "position_list.hpp"
+
+namespace libs {
+	namespace proccesing {
+/**
+ * \brief External aggregation of the word counts which don't fit into the ram-memory.
+ * The workers count into their own tables and spill them as runs sorted by the word once a memory budget is hit,
+ * the runs are combined by a k-way merge, so the disk is accessed only sequentially.
+ * The positions of the smileys are spilled along with the tables as separate runs, they are joined when queried.
+ * \tparam T the type of the words
+ * \tparam U the type of the counters, must be trivially copyable as it is written to the runs as is
+ */
+template <typename T, typename U>
+class spill_aggregator {
+	static_assert(std::is_trivially_copyable<U>::value, "The counter type must be trivially copyable");
+	public:
+		using counter_type = libs::datastructure::flat_counter<T, U>;
+		using smileys_map = std::unordered_map<T, libs::datastructure::position_list<U>>;
+		/// The maximal number of runs merged at once, more runs are merged by several passes
+		static constexpr size_t max_fan_in = 64;
+	private:
+		/// The size of the stream buffer of every run
+		static constexpr size_t io_buffer_size = 1 << 20;
+		/*
+		 * Writes a run: every record is the word length, the word bytes and the counter.
+		 */
+		class run_writer {
+			private:
+				std::vector<char> m_buffer;
+				std::ofstream m_os{};
+			public:
+				explicit run_writer(const std::filesystem::path& path): m_buffer(io_buffer_size) {
+					m_os.rdbuf()->pubsetbuf(m_buffer.data(), m_buffer.size());
+					m_os.open(path, std::ios::binary | std::ios::trunc);
+					if(!m_os) {
+						const std::string err_msg("Error: Can't create spill file: " + path.string());
+						throw libs::exception::custom_exception(err_msg.c_str());
+					}
+				}
+				void write(std::string_view word, U value) {
+					const uint32_t length = static_cast<uint32_t>(word.size());
+					m_os.write(reinterpret_cast<const char*>(&length), sizeof(length));
+					m_os.write(word.data(), word.size());
+					m_os.write(reinterpret_cast<const char*>(&value), sizeof(value));
+				}
+				void write_positions(std::string_view code, std::string_view bytes) {
+					const uint32_t length = static_cast<uint32_t>(code.size());
+					const uint64_t size = bytes.size();
+					m_os.write(reinterpret_cast<const char*>(&length), sizeof(length));
+					m_os.write(code.data(), code.size());
+					m_os.write(reinterpret_cast<const char*>(&size), sizeof(size));
+					m_os.write(bytes.data(), bytes.size());
+				}
+				void close() {
+					m_os.close();
+					if(m_os.fail()) {
+						throw libs::exception::custom_exception("Error: Can't write spill file");
+					}
+				}
+		};
+		/*
+		 * Reads a run record by record, keeps the current record.
+		 */
+		class run_reader {
+			private:
+				std::vector<char> m_buffer;
+				std::ifstream m_is{};
+				std::string m_word{};
+				U m_value{};
+			public:
+				explicit run_reader(const std::filesystem::path& path): m_buffer(io_buffer_size) {
+					m_is.rdbuf()->pubsetbuf(m_buffer.data(), m_buffer.size());
+					m_is.open(path, std::ios::binary);
+					if(!m_is) {
+						const std::string err_msg("Error: Can't open spill file: " + path.string());
+						throw libs::exception::custom_exception(err_msg.c_str());
+					}
+				}
+				bool next() {
+					uint32_t length = 0;
+					if(!m_is.read(reinterpret_cast<char*>(&length), sizeof(length))) {
+						return false;
+					}
+					m_word.resize(length);
+					m_is.read(m_word.data(), length);
+					m_is.read(reinterpret_cast<char*>(&m_value), sizeof(m_value));
+					if(!m_is) {
+						throw libs::exception::custom_exception("Error: Truncated spill file");
+					}
+					return true;
+				}
+				const std::string& word() const {
+					return m_word;
+				}
+				U value() const {
+					return m_value;
+				}
+		};
+		std::filesystem::path m_dir{};
+		std::string m_prefix{};
+		std::atomic<size_t> m_next_run{0};
+		std::vector<std::filesystem::path> m_runs{};
+		std::vector<std::filesystem::path> m_smiley_runs{};
+		mutable std::mutex m_mtx;
+	private:
+		std::filesystem::path next_run_path(const char* extension = ".run") {
+			return m_dir / (m_prefix + std::to_string(m_next_run++) + extension);
+		}
+		void add_run(std::filesystem::path&& path) {
+			std::lock_guard<std::mutex> lck(m_mtx);
+			m_runs.push_back(std::move(path));
+		}
+		void add_smiley_run(std::filesystem::path&& path) {
+			std::lock_guard<std::mutex> lck(m_mtx);
+			m_smiley_runs.push_back(std::move(path));
+		}
+		/*
+		 * Reads a run of the positions: every record is the code length, the code bytes, the list length and the encoded list.
+		 */
+		template <typename F>
+		static void read_positions(const std::filesystem::path& path, F&& fn) {
+			std::vector<char> buffer(io_buffer_size);
+			std::ifstream is{};
+			is.rdbuf()->pubsetbuf(buffer.data(), buffer.size());
+			is.open(path, std::ios::binary);
+			if(!is) {
+				const std::string err_msg("Error: Can't open spill file: " + path.string());
+				throw libs::exception::custom_exception(err_msg.c_str());
+			}
+			std::string code{};
+			std::string bytes{};
+			uint32_t length = 0;
+			while(is.read(reinterpret_cast<char*>(&length), sizeof(length))) {
+				uint64_t size = 0;
+				code.resize(length);
+				is.read(code.data(), length);
+				is.read(reinterpret_cast<char*>(&size), sizeof(size));
+				if(!is) {
+					throw libs::exception::custom_exception("Error: Truncated spill file");
+				}
+				bytes.resize(size);
+				if(!is.read(bytes.data(), size)) {
+					throw libs::exception::custom_exception("Error: Truncated spill file");
+				}
+				fn(std::string_view(code), std::string_view(bytes));
+			}
+		}
+		/*
+		 * Merges the runs by the word order, the equal words of the different runs are summed up.
+		 */
+		template <typename F>
+		static void merge_runs(const std::vector<std::filesystem::path>& runs, F&& fn) {
+			std::vector<std::unique_ptr<run_reader>> readers{};
+			readers.reserve(runs.size());
+			auto greater = [&readers](size_t lhs, size_t rhs) {
+				const int cmp = readers[lhs].get()->word().compare(readers[rhs].get()->word());
+				return cmp != 0 ? cmp > 0 : lhs > rhs;
+			};
+			std::priority_queue<size_t, std::vector<size_t>, decltype(greater)> heap(greater);
+			for(const auto& path: runs) {
+				readers.push_back(std::make_unique<run_reader>(path));
+				if(readers.back().get()->next()) {
+					heap.push(readers.size() - 1);
+				}
+			}
+			std::string word{};
+			while(!heap.empty()) {
+				size_t top = heap.top();
+				heap.pop();
+				word = readers[top].get()->word();
+				U value = readers[top].get()->value();
+				if(readers[top].get()->next()) {
+					heap.push(top);
+				}
+				while(!heap.empty() && readers[heap.top()].get()->word() == word) {
+					top = heap.top();
+					heap.pop();
+					value += readers[top].get()->value();
+					if(readers[top].get()->next()) {
+						heap.push(top);
+					}
+				}
+				fn(std::string_view(word), value);
+			}
+		}
+		/*
+		 * Merges the oldest runs into a single one until the remaining runs can be merged at once.
+		 */
+		void compact() {
+			while(m_runs.size() > max_fan_in) {
+				std::vector<std::filesystem::path> batch(m_runs.begin(), m_runs.begin() + max_fan_in);
+				std::filesystem::path path = next_run_path();
+				run_writer writer(path);
+				merge_runs(batch, [&writer](std::string_view word, U value) {
+						writer.write(word, value);
+						});
+				writer.close();
+				m_runs.erase(m_runs.begin(), m_runs.begin() + max_fan_in);
+				m_runs.push_back(std::move(path));
+				for(const auto& old: batch) {
+					std::error_code ec;
+					std::filesystem::remove(old, ec);
+				}
+			}
+		}
+	public:
+		/**
+		 * Constructor with an argument
+		 * \param spill_dir the directory the runs are written to, it is created if it doesn't exist
+		 */
+		explicit spill_aggregator(const std::string& spill_dir): m_dir(spill_dir) {
+			std::error_code ec;
+			std::filesystem::create_directories(m_dir, ec);
+			if(!std::filesystem::is_directory(m_dir)) {
+				const std::string err_msg("Error: Can't create spill directory: " + spill_dir);
+				throw libs::exception::custom_exception(err_msg.c_str());
+			}
+			std::random_device rd;
+			m_prefix = "spill_" + std::to_string(rd()) + "_";
+		}
+		/**
+		 * Destructor removes the runs
+		 */
+		~spill_aggregator() {
+			clear();
+		}
+		spill_aggregator(const spill_aggregator&) = delete;
+		spill_aggregator& operator=(const spill_aggregator&) = delete;
+		/**
+		 * Writes the table as a run sorted by the word, may be called concurrently by several workers
+		 * \param word_freq the table to spill
+		 * @returns `void`
+		 */
+		void spill(const counter_type& word_freq) {
+			if(word_freq.empty()) {
+				return;
+			}
+			std::vector<std::pair<std::string_view, U>> entries{};
+			entries.reserve(word_freq.size());
+			for(const auto& [word, freq]: word_freq) {
+				entries.emplace_back(word, freq);
+			}
+			std::sort(entries.begin(), entries.end(), [](const auto& lhs, const auto& rhs) {
+					return lhs.first < rhs.first;
+					});
+			std::filesystem::path path = next_run_path();
+			run_writer writer(path);
+			for(const auto& [word, freq]: entries) {
+				writer.write(word, freq);
+			}
+			writer.close();
+			add_run(std::move(path));
+		}
+		/**
+		 * Writes the positions of the smileys as a run, may be called concurrently by several workers
+		 * \param smileys the positions to spill
+		 * @returns `void`
+		 */
+		void spill_smileys(const smileys_map& smileys) {
+			if(smileys.empty()) {
+				return;
+			}
+			std::filesystem::path path = next_run_path(".pos");
+			run_writer writer(path);
+			for(const auto& [code, positions]: smileys) {
+				writer.write_positions(code, positions.bytes());
+			}
+			writer.close();
+			add_smiley_run(std::move(path));
+		}
+		/**
+		 * Gets the number of the runs of the words written so far
+		 * @returns `size_t`
+		 */
+		size_t runs_count() const {
+			std::lock_guard<std::mutex> lck(m_mtx);
+			return m_runs.size();
+		}
+		/**
+		 * Gets the number of the runs of the smileys' positions written so far
+		 * @returns `size_t`
+		 */
+		size_t smiley_runs_count() const {
+			std::lock_guard<std::mutex> lck(m_mtx);
+			return m_smiley_runs.size();
+		}
+		/**
+		 * Calls the function for every word in the word order with its total count.
+		 * Should be called once the spilling is finished.
+		 * \param fn the callable taking the word as `std::string_view` and the counter
+		 * @returns `void`
+		 */
+		template <typename F>
+		void for_each(F&& fn) {
+			std::lock_guard<std::mutex> lck(m_mtx);
+			compact();
+			merge_runs(m_runs, std::forward<F>(fn));
+		}
+		/**
+		 * Gets n most frequent words keeping only n candidates in the ram-memory,
+		 * the words of the equal frequency are ordered alphabetically
+		 * \param n the number of the words
+		 * @returns `std::vector<std::pair<T, U>>` ordered by the frequency descending
+		 */
+		std::vector<std::pair<T, U>> top_n(size_t n) {
+			std::vector<std::pair<T, U>> heap{};
+			if(n == 0) {
+				return heap;
+			}
+			auto better = [](const std::pair<T, U>& lhs, const std::pair<T, U>& rhs) {
+				return lhs.second != rhs.second ? lhs.second > rhs.second : lhs.first < rhs.first;
+			};
+			heap.reserve(n);
+			for_each([&heap, &better, n](std::string_view word, U value) {
+					if(heap.size() < n) {
+						heap.emplace_back(T(word), value);
+						std::push_heap(heap.begin(), heap.end(), better);
+					} else if(value > heap.front().second) {
+						// The words come in the alphabetical order, so a tie never beats the candidate
+						std::pop_heap(heap.begin(), heap.end(), better);
+						heap.back() = std::make_pair(T(word), value);
+						std::push_heap(heap.begin(), heap.end(), better);
+					}
+					});
+			std::sort_heap(heap.begin(), heap.end(), better);
+			return heap;
+		}
+		/**
+		 * Loads the merged counts into a hash map, should be used only if they fit into the ram-memory
+		 * @returns `std::unordered_map<T, U>`
+		 */
+		std::unordered_map<T, U> to_map() {
+			std::unordered_map<T, U> ret{};
+			for_each([&ret](std::string_view word, U value) {
+					ret.emplace(T(word), value);
+					});
+			return ret;
+		}
+		/**
+		 * Joins the spilled positions of every smiley in the order of the runs, should be used only if they fit into the ram-memory
+		 * @returns `smileys_map` where the key is a smiley character and the value is it's positions
+		 */
+		smileys_map smileys_to_map() const {
+			std::lock_guard<std::mutex> lck(m_mtx);
+			smileys_map ret{};
+			for(const auto& path: m_smiley_runs) {
+				read_positions(path, [&ret](std::string_view code, std::string_view bytes) {
+						ret[T(code)].append(libs::datastructure::position_list<U>::from_bytes(bytes));
+						});
+			}
+			return ret;
+		}
+		/**
+		 * Removes all the runs
+		 * @returns `void`
+		 */
+		void clear() {
+			std::lock_guard<std::mutex> lck(m_mtx);
+			for(const auto& path: m_runs) {
+				std::error_code ec;
+				std::filesystem::remove(path, ec);
+			}
+			for(const auto& path: m_smiley_runs) {
+				std::error_code ec;
+				std::filesystem::remove(path, ec);
+			}
+			m_runs.clear();
+			m_smiley_runs.clear();
+		}
+};
+}
+}
+
+#endif // __SPILL_AGGREGATOR_HPP__
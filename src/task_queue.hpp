@@ -11,6 +11,8 @@ namespace libs {
 
 /**
  * \brief Implements a thread safe queue which is required to hold pending tasks.
+ * The engine uses `mpmc_ring_buffer`, the queue is kept only as the baseline of the queue benchmarks,
+ * which is why it still has the capacity, `wait_and_pop` and `close`/`reopen` of the ring.
  * \tparam T the type of data stored in the map as a key
  * \tparam U the type of data stored in the map as a value
  */
@@ -22,6 +24,12 @@ public:
    * The default constructor
    */
   task_queue() {}
+  /**
+   * Constructor with an argument
+   * \param capacity the maximum number of pending tasks, `push` blocks while the queue is full.
+   *      The value `0` means unbounded queue.
+   */
+  explicit task_queue(size_t capacity): m_capacity(capacity) {}
   /**
    * The destructor
    */
@@ -36,8 +44,9 @@ public:
    */
   void push(std::tuple<T, U, U>&& t)
   {
-    std::unique_ptr<std::tuple<T, U, U>> value(std::make_unique<std::tuple<T, U, U>>(t));
-    std::lock_guard<std::mutex> lck(m_mtx);
+    std::unique_ptr<std::tuple<T, U, U>> value(std::make_unique<std::tuple<T, U, U>>(std::move(t)));
+    std::unique_lock<std::mutex> lck(m_mtx);
+    m_not_full.wait(lck, [&]{ return m_capacity == 0 || m_queue.size() < m_capacity || m_closed;});
     m_queue.push(std::move(value));
     m_cnd.notify_one();
   }
@@ -58,8 +67,54 @@ public:
     m_cnd.wait(lck, [&]{ return !m_queue.empty();});
     std::unique_ptr<std::tuple<T, U, U>> val(std::move(m_queue.front()));
     m_queue.pop();
+    m_not_full.notify_one();
     return val;
   }
+  /**
+   * Thread-safely pops the task from the queue, blocks while the queue is empty and not closed
+   * @return `std::unique_ptr<std::tuple<T, U, U>>` or `nullptr` if the queue is closed and drained
+   */
+  std::unique_ptr<std::tuple<T, U, U>> wait_and_pop()
+  {
+    std::unique_lock<std::mutex> lck(m_mtx);
+    m_cnd.wait(lck, [&]{ return !m_queue.empty() || m_closed;});
+    if(m_queue.empty()) {
+	    return nullptr;
+    }
+    std::unique_ptr<std::tuple<T, U, U>> val(std::move(m_queue.front()));
+    m_queue.pop();
+    m_not_full.notify_one();
+    return val;
+  }
+  /**
+   * Closes the queue, so the consumers blocked in `wait_and_pop` are woken up as soon as the queue is drained
+   * @returns `void`
+   */
+  void close()
+  {
+	  std::lock_guard<std::mutex> lck(m_mtx);
+	  m_closed = true;
+	  m_cnd.notify_all();
+	  m_not_full.notify_all();
+  }
+  /**
+   * Reopens the closed queue, so it can be reused for the next batch of tasks
+   * @returns `void`
+   */
+  void reopen()
+  {
+	  std::lock_guard<std::mutex> lck(m_mtx);
+	  m_closed = false;
+  }
+  /**
+   * Checks whether the queue is closed
+   * @returns `bool`
+   */
+  bool is_closed() const
+  {
+	  std::lock_guard<std::mutex> lck(m_mtx);
+	  return m_closed;
+  }
   /**
    * Checks whether the queue is empty
    * @returns `bool`
@@ -85,7 +140,10 @@ private:
   task_queue& operator=(const task_queue<T, U>&&)=delete;
 private:
   std::condition_variable m_cnd;
+  std::condition_variable m_not_full;
   mutable std::mutex m_mtx;
+  size_t m_capacity{0};
+  bool m_closed{false};
   std::queue<std::unique_ptr<std::tuple<T, U, U>>> m_queue;
 };
 }
@@ -0,0 +1,66 @@
+#ifndef __TEXT_SPAN_HPP__
+#define __TEXT_SPAN_HPP__
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace libs {
+	namespace utils {
+/**
+ * \brief A read-only view to a chunk of text which keeps alive the storage it points to.
+ * The storage is either an owned `std::string` or a foreign buffer, e.g. a memory mapped window of the input file,
+ * so the chunks can be passed to the workers without copying the underlying bytes.
+ */
+class text_span {
+	private:
+		std::shared_ptr<const void> m_owner{};
+		std::string_view m_view{};
+	public:
+		/**
+		 * Default constructor, creates an empty span
+		 */
+		text_span() = default;
+		/**
+		 * Constructor with an argument, takes the ownership of the string
+		 * \param text the chunk of text
+		 */
+		explicit text_span(std::string&& text) {
+			std::shared_ptr<const std::string> owner = std::make_shared<const std::string>(std::move(text));
+			m_view = *owner;
+			m_owner = std::move(owner);
+		}
+		/**
+		 * Constructor with arguments, refers to the foreign buffer
+		 * \param view the chunk of text
+		 * \param owner the object which owns the buffer referred by `view`, it is kept alive while the span exists
+		 */
+		text_span(std::string_view view, std::shared_ptr<const void> owner): 
+			m_owner(std::move(owner)), 
+			m_view(view) {}
+		/**
+		 * Gets the text
+		 * @returns `std::string_view`
+		 */
+		std::string_view view() const {
+			return m_view;
+		}
+		/**
+		 * Gets the text length
+		 * @returns `size_t`
+		 */
+		size_t length() const {
+			return m_view.length();
+		}
+		/**
+		 * Checks whether the span is empty
+		 * @returns `bool`
+		 */
+		bool empty() const {
+			return m_view.empty();
+		}
+};
+}
+}
+
+#endif // __TEXT_SPAN_HPP__
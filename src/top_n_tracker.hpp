@@ -0,0 +1,97 @@
+#ifndef __TOP_N_TRACKER_HPP__
+#define __TOP_N_TRACKER_HPP__
+
+#include <iterator>
+#include <set>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace libs {
+	namespace datastructure {
+/**
+ * \brief Keeps the n entries with the greatest counters while the counters grow, so the top is known at any time
+ * without scanning the whole table. The counters only grow, so an entry outside of the top can enter it only when
+ * its own counter is updated: every update is O(log n) and the top is exact. The order is the one of `flat_counter::top_n`,
+ * the greater counter first and the equal counters by the key.
+ * \tparam U the counter type
+ */
+template <typename U>
+class top_n_tracker {
+	private:
+		using entry = std::pair<std::string, U>;
+		struct ranks_before {
+			using is_transparent = void;
+			template <typename L, typename R>
+			bool operator()(const L& lhs, const R& rhs) const {
+				return lhs.second != rhs.second ? lhs.second > rhs.second : std::string_view(lhs.first) < std::string_view(rhs.first);
+			}
+		};
+		size_t m_capacity{0};
+		std::set<entry, ranks_before> m_top{};
+	public:
+		/**
+		 * Constructor with an argument
+		 * \param capacity the number of the entries kept
+		 */
+		explicit top_n_tracker(size_t capacity): m_capacity(capacity) {}
+		/**
+		 * Updates the counter of the key
+		 * \param key the key
+		 * \param previous the counter before the update, `0` for a new key
+		 * \param count the counter after the update, not less than `previous`
+		 * @returns `void`
+		 */
+		void update(std::string_view key, U previous, U count) {
+			if(m_capacity == 0) {
+				return;
+			}
+			const auto it = m_top.find(std::make_pair(key, previous));
+			if(it != m_top.end()) {
+				auto node = m_top.extract(it);
+				node.value().second = count;
+				m_top.insert(std::move(node));
+				return;
+			}
+			const std::pair<std::string_view, U> candidate(key, count);
+			if(m_top.size() == m_capacity) {
+				const auto worst = std::prev(m_top.end());
+				if(!ranks_before()(candidate, *worst)) {
+					return;
+				}
+				m_top.erase(worst);
+			}
+			m_top.emplace(std::string(key), count);
+		}
+		/**
+		 * Gets n entries with the greatest counters
+		 * \param n the number of the entries, at most the capacity
+		 * @returns `std::vector<std::pair<std::string_view, U>>` ordered by the counter descending, the keys refer to the tracker
+		 */
+		std::vector<std::pair<std::string_view, U>> top(size_t n) const {
+			std::vector<std::pair<std::string_view, U>> ret{};
+			for(auto it = m_top.begin(); it != m_top.end() && ret.size() < n; ++it) {
+				ret.emplace_back(it->first, it->second);
+			}
+			return ret;
+		}
+		/**
+		 * Gets the number of the entries kept
+		 * @returns `size_t`
+		 */
+		size_t capacity() const {
+			return m_capacity;
+		}
+		/**
+		 * Removes all the entries
+		 * @returns `void`
+		 */
+		void clear() {
+			m_top.clear();
+		}
+};
+}
+}
+
+#endif // __TOP_N_TRACKER_HPP__
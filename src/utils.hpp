@@ -4,27 +4,300 @@
 #include <algorithm>
 #include <boost/algorithm/string.hpp>
 #include <iterator>
-#include <regex>
+#include <array>
+#include <cstring>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <tuple>
 #include <unordered_map>
 #include <vector>
 
 namespace libs {
 
 namespace utils {
+	/// The characters which separate the words
+	constexpr char special_characters[] = "\t\n,.;`\"?<>/+-*!@#$%^&~({[)}]: ";
+	/**
+	 * \brief 256-entry lookup table which classifies every byte as a delimiter or a word character
+	 */
+	struct delimiters_table {
+		bool is_delimiter[256]{};
+		constexpr delimiters_table(): is_delimiter{} {
+			for(size_t i = 0; i + 1 < sizeof(special_characters); ++i) {
+				is_delimiter[static_cast<unsigned char>(special_characters[i])] = true;
+			}
+		}
+	};
+	constexpr delimiters_table special_characters_table{};
+	/**
+	 * Checks whether the character separates the words
+	 * \param c the character
+	 * @returns `bool`
+	 */
+	inline bool is_special_character(char c) {
+		return special_characters_table.is_delimiter[static_cast<unsigned char>(c)];
+	}
+	/**
+	 * Tokenizes the text chunk using the special characters as a delimiters without any allocation.
+	 * Empty tokens are skipped.
+	 * \tparam F the callable type
+	 * \param input text chunk
+	 * \param fn the callable which is invoked with every word as `std::string_view` referring to the `input`
+	 * @returns `void`
+	 */
+	template <typename F>
+	void for_each_word(std::string_view input, F&& fn) {
+		const char* const begin = input.data();
+		const char* const end = begin + input.size();
+		const char* cur = begin;
+		while(cur != end) {
+			while(cur != end && is_special_character(*cur)) {
+				++cur;
+			}
+			const char* word = cur;
+			while(cur != end && !is_special_character(*cur)) {
+				++cur;
+			}
+			if(cur != word) {
+				fn(std::string_view(word, cur - word));
+			}
+		}
+	}
 	/**
 	 * Splits the text chunk using most severa; special characters as a delimiters
 	 * \param input text chunk
 	 * \param eCompress indicates whether to compress intermediate whitespaces
 	 * @returns `std::vector<std::string>` splitted and/or compressed text chunk 
 	 */
-	std::vector<std::string> split_by_any_of_special_character(const std::string& input, 
+	inline std::vector<std::string> split_by_any_of_special_character(std::string_view input, 
 			boost::algorithm::token_compress_mode_type eCompress=boost::token_compress_on) {
 		std::vector<std::string> words{};
-		boost::split(words, input, boost::is_any_of("\t\n,.;`\"?<>/+-*!@#$%^&~({[)}]: "), eCompress);
+		size_t start = 0;
+		for(size_t i = 0; i < input.size(); ++i) {
+			if(!is_special_character(input[i])) {
+				continue;
+			}
+			words.emplace_back(input.substr(start, i - start));
+			if(eCompress == boost::token_compress_on) {
+				while(i + 1 < input.size() && is_special_character(input[i + 1])) {
+					++i;
+				}
+			}
+			start = i + 1;
+		}
+		words.emplace_back(input.substr(start));
 		return words;	
 	}
 	/**
-	 * Uses regular expresions to extract smileys and calculates their global positions into the whole text
+	 * \brief The set of emoticons the text is scanned for.
+	 * The patterns are grouped by their first character, so the scanner tries only the patterns which could start at the current byte.
+	 * When several patterns match at the same position the longest one wins, the matches don't overlap.
+	 */
+	class smiley_set {
+		private:
+			std::vector<std::string> m_patterns{};
+			std::array<std::vector<size_t>, 256> m_by_first{};
+			std::array<bool, 256> m_is_first{};
+			std::array<unsigned char, 256> m_classes = make_classes();
+			static std::array<unsigned char, 256> make_classes() {
+				std::array<unsigned char, 256> classes{};
+				for(size_t c = 0; c < classes.size(); ++c) {
+					classes[c] = special_characters_table.is_delimiter[c] ? special_character_class : 0;
+				}
+				return classes;
+			}
+			size_t m_first_count{0};
+			char m_first{0};
+		public:
+			/// The class bit of the characters which separate the words
+			static constexpr unsigned char special_character_class = 1;
+			/// The class bit of the characters some emoticon starts with
+			static constexpr unsigned char first_character_class = 2;
+			/**
+			 * Default constructor, creates an empty set
+			 */
+			smiley_set() = default;
+			/**
+			 * Constructor with an argument
+			 * \param patterns the emoticons
+			 */
+			smiley_set(std::initializer_list<std::string_view> patterns) {
+				for(auto& pattern: patterns) {
+					add(pattern);
+				}
+			}
+			/**
+			 * Gets the default set, i.e. a colon, an optional dash and one of the brackets `)}](\[{`
+			 * @returns `const smiley_set&`
+			 */
+			static const smiley_set& defaults() {
+				static const smiley_set set{":)", ":}", ":]", ":(", ":{", ":[",
+					":-)", ":-}", ":-]", ":-(", ":-{", ":-["};
+				return set;
+			}
+			/**
+			 * Adds the emoticon to the set
+			 * \param pattern the emoticon, empty patterns and duplicates are ignored
+			 * @returns `void`
+			 */
+			void add(std::string_view pattern) {
+				if(pattern.empty() || std::find(m_patterns.begin(), m_patterns.end(), pattern) != m_patterns.end()) {
+					return;
+				}
+				std::vector<size_t>& group = m_by_first[static_cast<unsigned char>(pattern.front())];
+				if(group.empty()) {
+					++m_first_count;
+					m_first = pattern.front();
+					m_is_first[static_cast<unsigned char>(pattern.front())] = true;
+					m_classes[static_cast<unsigned char>(pattern.front())] |= first_character_class;
+				}
+				m_patterns.emplace_back(pattern);
+				group.push_back(m_patterns.size() - 1);
+				std::stable_sort(group.begin(), group.end(), [this](size_t l, size_t r) {
+						return m_patterns[l].size() > m_patterns[r].size();
+						});
+			}
+			/**
+			 * Gets the emoticons
+			 * @returns `const std::vector<std::string>&`
+			 */
+			const std::vector<std::string>& patterns() const {
+				return m_patterns;
+			}
+			/**
+			 * Checks whether some emoticon starts with the character
+			 * \param c the character
+			 * @returns `bool`
+			 */
+			bool is_first_character(char c) const {
+				return m_is_first[static_cast<unsigned char>(c)];
+			}
+			/**
+			 * Gets the class bits of the character, i.e. whether it separates the words and/or starts some emoticon
+			 * \param c the character
+			 * @returns `unsigned char`
+			 */
+			unsigned char character_class(char c) const {
+				return m_classes[static_cast<unsigned char>(c)];
+			}
+			/**
+			 * Matches the longest emoticon at the position
+			 * \param text the text
+			 * \param pos the position in the text
+			 * @returns `size_t` the length of the matched emoticon or `0`
+			 */
+			size_t match(std::string_view text, size_t pos) const {
+				for(size_t idx: m_by_first[static_cast<unsigned char>(text[pos])]) {
+					const std::string& pattern = m_patterns[idx];
+					if(text.compare(pos, pattern.size(), pattern) == 0) {
+						return pattern.size();
+					}
+				}
+				return 0;
+			}
+			/**
+			 * Scans the text for the emoticons
+			 * \tparam F the callable type
+			 * \param text the text
+			 * \param fn the callable which is invoked with the offset of every emoticon in the text and the emoticon itself
+			 * @returns `void`
+			 */
+			template <typename F>
+			void scan(std::string_view text, F&& fn) const {
+				size_t pos = 0;
+				while(pos < text.size()) {
+					if(m_first_count == 1) {
+						const void* found = std::memchr(text.data() + pos, m_first, text.size() - pos);
+						if(found == nullptr) {
+							return;
+						}
+						pos = static_cast<const char*>(found) - text.data();
+					} else if(!is_first_character(text[pos])) {
+						++pos;
+						continue;
+					}
+					const size_t length = match(text, pos);
+					if(length == 0) {
+						++pos;
+						continue;
+					}
+					fn(pos, text.substr(pos, length));
+					pos += length;
+				}
+			}
+	};
+	/**
+	 * Tokenizes the text chunk and scans it for the emoticons in a single pass, so every byte is touched once.
+	 * Gives the same words as `for_each_word` and the same emoticons as `smiley_set::scan`.
+	 * \tparam W the words callable type
+	 * \tparam S the emoticons callable type
+	 * \param input text chunk
+	 * \param set the emoticons to search for
+	 * \param on_word the callable which is invoked with every non-empty word as `std::string_view` referring to the `input`
+	 * \param on_smiley the callable which is invoked with the offset of every emoticon in the text and the emoticon itself
+	 * @returns `void`
+	 */
+	template <typename W, typename S>
+	void for_each_word_and_smiley(std::string_view input, const smiley_set& set, W&& on_word, S&& on_smiley) {
+		const size_t size = input.size();
+		size_t word = size;
+		size_t next_smiley = 0;
+		size_t i = 0;
+		while(true) {
+			const size_t start = i;
+			while(i < size && set.character_class(input[i]) == 0) {
+				++i;
+			}
+			if(i != start && word == size) {
+				word = start;
+			}
+			if(i == size) {
+				break;
+			}
+			const unsigned char cls = set.character_class(input[i]);
+			if((cls & smiley_set::first_character_class) && i >= next_smiley) {
+				const size_t length = set.match(input, i);
+				if(length != 0) {
+					on_smiley(i, input.substr(i, length));
+					next_smiley = i + length;
+				}
+			}
+			if(cls & smiley_set::special_character_class) {
+				if(word != size) {
+					on_word(input.substr(word, i - word));
+					word = size;
+				}
+			} else if(word == size) {
+				word = i;
+			}
+			++i;
+		}
+		if(word != size) {
+			on_word(input.substr(word));
+		}
+	}
+	/**
+	 * Extracts smileys and calculates their global positions into the whole text
+	 * \tparam T the key type/smiley character
+	 * \tparam U the value type/smileys position
+	 * \tparam Positions the container of the positions of a smiley, having `push_back`
+	 * \param text the input text
+	 * \param end the global position of the text's end
+	 * \param smileys represents a reference to an hash map variable which holds smileys and their positions
+	 * \param set the emoticons to search for
+	 * @returns `void`
+	 */
+	template <typename T, typename U, typename Positions = std::vector<U>>
+	void search_smileys(std::string_view text, U end,
+			std::unordered_map<T, Positions>& smileys, const smiley_set& set = smiley_set::defaults()) {
+		const U base = end - text.size() + 1;
+		set.scan(text, [&smileys, base](size_t offset, std::string_view code) {
+				smileys[T(code)].push_back(base + offset);
+				});
+	}
+	/**
+	 * Extracts smileys and calculates their global positions into the whole text
 	 * \tparam T the key type/smiley character
 	 * \tparam U the value type/smileys position
 	 * \param tuple holds input text, the global position of it's end and the length of that text
@@ -34,15 +307,8 @@ namespace utils {
 	template <typename T, typename U>
 	void search_smileys(const std::tuple<T, U, U>& tuple, 
 			std::unordered_map<T, std::vector<U>>& smileys) {
-		std::smatch res;
-		const std::regex pat("(:-?(\\)|\\}|\\]|\\(|\\{|\\[))");
 		const T& item = std::get<0>(tuple);
-		for(std::sregex_iterator it = 
-				std::sregex_iterator(item.cbegin(), item.cend(), pat); 
-				it != std::sregex_iterator(); ++it) {
-			std::smatch match = *it;
-			smileys[match.str()].push_back(std::get<1>(tuple) - std::get<2>(tuple) + match.position() + 1);
-		}
+		search_smileys<T, U>(std::string_view(item).substr(0, std::get<2>(tuple)), std::get<1>(tuple), smileys);
 	}
 	
 	template <int flag, typename U, typename V, typename Y>
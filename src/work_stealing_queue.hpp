@@ -0,0 +1,274 @@
+#ifndef __WORK_STEALING_QUEUE_HPP__
+#define __WORK_STEALING_QUEUE_HPP__
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace libs {
+	namespace safe_datastructure {
+
+/**
+ * \brief The scheduling statistics of a single worker
+ */
+struct worker_stats {
+	/// The number of the tasks the worker has executed
+	size_t executed{0};
+	/// The number of the successful steals
+	size_t steals{0};
+	/// The number of the tasks taken from the other workers
+	size_t stolen_tasks{0};
+	/// The time the worker spent waiting for a task
+	std::chrono::nanoseconds idle_time{0};
+};
+
+/**
+ * \brief Distributes the tasks over the per-worker deques, an idle worker steals half of the tasks of a random victim.
+ * The producer deals the tasks round robin, every worker takes the oldest task of its own deque and the thieves take
+ * the newest ones, so the owner and the thieves rarely meet on the same lock. The total number of the pending tasks is bounded,
+ * `push` blocks while the bound is reached.
+ * \tparam Task the type of the tasks
+ */
+template <typename Task>
+class work_stealing_queue
+{
+	private:
+		/// The number of the failed attempts before an idle worker goes to sleep
+		static constexpr size_t spin_count = 64;
+		struct alignas(64) worker_deque {
+			std::mutex mtx;
+			std::deque<Task> tasks{};
+			std::atomic<size_t> size{0};
+			uint64_t random_state{0};
+			worker_stats stats{};
+		};
+		std::vector<std::unique_ptr<worker_deque>> m_deques{};
+		size_t m_capacity{0};
+		std::atomic<size_t> m_next{0};
+		alignas(64) std::atomic<size_t> m_pending{0};
+		std::atomic<bool> m_closed{false};
+		std::atomic<size_t> m_waiting_consumers{0};
+		std::atomic<size_t> m_waiting_producers{0};
+		std::mutex m_mtx;
+		std::condition_variable m_not_empty;
+		std::condition_variable m_not_full;
+	private:
+		void signal(std::atomic<size_t>& waiting, std::condition_variable& cnd) {
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if(waiting.load(std::memory_order_relaxed) != 0) {
+				std::lock_guard<std::mutex> lck(m_mtx);
+				cnd.notify_one();
+			}
+		}
+		std::optional<Task> pop_local(worker_deque& own) {
+			if(own.size.load(std::memory_order_acquire) == 0) {
+				return std::nullopt;
+			}
+			std::lock_guard<std::mutex> lck(own.mtx);
+			if(own.tasks.empty()) {
+				return std::nullopt;
+			}
+			std::optional<Task> ret(std::move(own.tasks.front()));
+			own.tasks.pop_front();
+			own.size.store(own.tasks.size(), std::memory_order_release);
+			return ret;
+		}
+		/*
+		 * Takes the newer half of a random victim's tasks, returns one of them and keeps the rest in the own deque.
+		 */
+		std::optional<Task> steal(size_t worker) {
+			worker_deque& own = *m_deques[worker];
+			const size_t count = m_deques.size();
+			// xorshift, every worker has its own state
+			own.random_state ^= own.random_state << 13;
+			own.random_state ^= own.random_state >> 7;
+			own.random_state ^= own.random_state << 17;
+			const size_t first = own.random_state % count;
+			for(size_t i = 0; i < count; ++i) {
+				const size_t victim_id = (first + i) % count;
+				if(victim_id == worker) {
+					continue;
+				}
+				worker_deque& victim = *m_deques[victim_id];
+				if(victim.size.load(std::memory_order_acquire) == 0) {
+					continue;
+				}
+				std::vector<Task> loot{};
+				{
+					std::lock_guard<std::mutex> lck(victim.mtx);
+					const size_t take = (victim.tasks.size() + 1) / 2;
+					for(size_t t = 0; t < take; ++t) {
+						loot.push_back(std::move(victim.tasks.back()));
+						victim.tasks.pop_back();
+					}
+					victim.size.store(victim.tasks.size(), std::memory_order_release);
+				}
+				if(loot.empty()) {
+					continue;
+				}
+				++own.stats.steals;
+				own.stats.stolen_tasks += loot.size();
+				std::optional<Task> ret(std::move(loot.back()));
+				loot.pop_back();
+				if(!loot.empty()) {
+					std::lock_guard<std::mutex> lck(own.mtx);
+					for(auto it = loot.rbegin(); it != loot.rend(); ++it) {
+						own.tasks.push_back(std::move(*it));
+					}
+					own.size.store(own.tasks.size(), std::memory_order_release);
+				}
+				return ret;
+			}
+			return std::nullopt;
+		}
+		std::optional<Task> try_take(size_t worker) {
+			std::optional<Task> ret = pop_local(*m_deques[worker]);
+			if(!ret) {
+				ret = steal(worker);
+			}
+			return ret;
+		}
+		std::optional<Task> taken(size_t worker, std::optional<Task>&& task) {
+			++m_deques[worker]->stats.executed;
+			// the blocked producer is woken once half of the capacity is free, not for every single task
+			if(m_pending.fetch_sub(1, std::memory_order_acq_rel) - 1 <= m_capacity / 2) {
+				signal(m_waiting_producers, m_not_full);
+			}
+			return std::move(task);
+		}
+	public:
+		/**
+		 * Constructor with arguments
+		 * \param workers the number of the workers, every one gets its own deque
+		 * \param capacity the maximum number of the pending tasks of all the workers
+		 */
+		work_stealing_queue(size_t workers, size_t capacity) {
+			workers = std::max<size_t>(workers, 1);
+			m_capacity = std::max<size_t>(capacity, 1);
+			for(size_t i = 0; i < workers; ++i) {
+				m_deques.push_back(std::make_unique<worker_deque>());
+				m_deques.back()->random_state = 0x9E3779B97F4A7C15ull * (i + 1);
+			}
+		}
+		work_stealing_queue(const work_stealing_queue&) = delete;
+		work_stealing_queue& operator=(const work_stealing_queue&) = delete;
+		/**
+		 * Deals the task to the next worker's deque, blocks while the number of the pending tasks reaches the capacity
+		 * \param task the task
+		 * @returns `bool` `false` if the queue has been closed and the task is dropped
+		 */
+		bool push(Task&& task) {
+			if(m_pending.load(std::memory_order_acquire) >= m_capacity) {
+				std::unique_lock<std::mutex> lck(m_mtx);
+				m_waiting_producers.fetch_add(1, std::memory_order_seq_cst);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				m_not_full.wait(lck, [this]{
+						return m_pending.load(std::memory_order_acquire) < m_capacity || m_closed.load(std::memory_order_acquire);
+						});
+				m_waiting_producers.fetch_sub(1, std::memory_order_relaxed);
+			}
+			if(m_closed.load(std::memory_order_acquire)) {
+				return false;
+			}
+			// counted before it is published, so a worker taking it never sees the counter wrap around
+			m_pending.fetch_add(1, std::memory_order_acq_rel);
+			worker_deque& target = *m_deques[m_next.fetch_add(1, std::memory_order_relaxed) % m_deques.size()];
+			{
+				std::lock_guard<std::mutex> lck(target.mtx);
+				target.tasks.push_back(std::move(task));
+				target.size.store(target.tasks.size(), std::memory_order_release);
+			}
+			signal(m_waiting_consumers, m_not_empty);
+			return true;
+		}
+		/**
+		 * Takes a task of the worker's deque or steals from the others, blocks while there is nothing to do
+		 * \param worker the worker's index
+		 * @returns `std::optional<Task>` which is empty if the queue is closed and drained
+		 */
+		std::optional<Task> pop(size_t worker) {
+			if(std::optional<Task> ret = try_take(worker)) {
+				return taken(worker, std::move(ret));
+			}
+			const auto idle_start = std::chrono::steady_clock::now();
+			std::optional<Task> ret{};
+			for(size_t i = 0; i < spin_count && !ret; ++i) {
+				if(m_closed.load(std::memory_order_acquire) && m_pending.load(std::memory_order_acquire) == 0) {
+					break;
+				}
+				std::this_thread::yield();
+				ret = try_take(worker);
+			}
+			while(!ret) {
+				std::unique_lock<std::mutex> lck(m_mtx);
+				m_waiting_consumers.fetch_add(1, std::memory_order_seq_cst);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				m_not_empty.wait(lck, [this]{
+						return m_pending.load(std::memory_order_acquire) != 0 || m_closed.load(std::memory_order_acquire);
+						});
+				m_waiting_consumers.fetch_sub(1, std::memory_order_relaxed);
+				const bool drained = m_closed.load(std::memory_order_acquire) && m_pending.load(std::memory_order_acquire) == 0;
+				lck.unlock();
+				ret = try_take(worker);
+				if(!ret && drained) {
+					break;
+				}
+				if(!ret) {
+					// the pending tasks are held by a thief which hasn't published them yet
+					std::this_thread::yield();
+				}
+			}
+			m_deques[worker]->stats.idle_time += std::chrono::steady_clock::now() - idle_start;
+			if(!ret) {
+				return std::nullopt;
+			}
+			return taken(worker, std::move(ret));
+		}
+		/**
+		 * Closes the queue: the pending tasks are still handed out, then the workers get an empty result
+		 * @returns `void`
+		 */
+		void close() {
+			std::lock_guard<std::mutex> lck(m_mtx);
+			m_closed.store(true, std::memory_order_release);
+			m_not_empty.notify_all();
+			m_not_full.notify_all();
+		}
+		/**
+		 * Reopens the closed queue, so it can be reused for the next batch of tasks
+		 * @returns `void`
+		 */
+		void reopen() {
+			std::lock_guard<std::mutex> lck(m_mtx);
+			m_closed.store(false, std::memory_order_release);
+		}
+		/**
+		 * Gets the number of the pending tasks
+		 * @returns `size_t`
+		 */
+		size_t size() const {
+			return m_pending.load(std::memory_order_acquire);
+		}
+		/**
+		 * Gets the scheduling statistics of every worker, should be called once the workers are stopped
+		 * @returns `std::vector<worker_stats>`
+		 */
+		std::vector<worker_stats> get_stats() const {
+			std::vector<worker_stats> ret{};
+			for(const auto& deque: m_deques) {
+				ret.push_back(deque->stats);
+			}
+			return ret;
+		}
+};
+}
+}
+#endif // __WORK_STEALING_QUEUE_HPP__
@@ -1,8 +1,15 @@
 #define BOOST_TEST_MAIN
 #define BOOST_TEST_MODULE TEST_IOENGINE
 #include <boost/test/included/unit_test.hpp>
+#include <csignal>
+#include <map>
+#include <regex>
+#include <sstream>
 #include <unordered_map>
 #include <vector>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 #include "io_engine.hpp"
 
@@ -261,3 +268,1494 @@ BOOST_FIXTURE_TEST_CASE(TEST_DB_INVALID_SMYLE, file_op_fixture)
 	std::unordered_map<std::string, std::vector<size_t>> smyleis = obj_db.get_smileys_map();
 	BOOST_CHECK_EQUAL(smyleis.size(), 0);
 }
+
+// TESTS WITH WORKER POOL
+// Testing that the result doesn't depend on the number of workers. 
+BOOST_AUTO_TEST_CASE(TEST_WORKERS_COUNT_INDEPENDENT_RESULT)
+{
+	libs::proccesing::io_engine<std::string, size_t> single("./test/test_files/file.txt", 64, "", 1);
+	libs::proccesing::io_engine<std::string, size_t> multi("./test/test_files/file.txt", 64, "", 4);
+	BOOST_CHECK_EQUAL(multi.get_workers_count(), 4);
+	single.read();
+	multi.read();
+	bool result = (single.get_map() == multi.get_map());
+	BOOST_CHECK_EQUAL(result, true);
+	result = (single.get_smileys_map() == multi.get_smileys_map());
+	BOOST_CHECK_EQUAL(result, true);
+}
+// Testing the analysis engine processes the tasks pushed while the workers are running. 
+BOOST_AUTO_TEST_CASE(TEST_ANALYZE_ENGINE_SUBMIT)
+{
+	libs::analysis::analyze_stats_engine<std::string, size_t> stats(
+			std::make_unique<libs::analysis::analyze_stats_engine<std::string, size_t>::queue_type>(2), 3);
+	stats.start();
+	for(size_t i = 0; i < 100; ++i) {
+		std::string text("one two :) ");
+		const size_t length = text.length();
+		stats.submit({std::move(text), (i + 1) * length, length});
+	}
+	stats.wait();
+	std::unordered_map<std::string, size_t> freq = stats.get_map();
+	BOOST_CHECK_EQUAL(freq.size(), 2);
+	BOOST_CHECK_EQUAL(freq["one"], 100);
+	BOOST_CHECK_EQUAL(freq["two"], 100);
+	std::unordered_map<std::string, std::vector<size_t>> smileys = stats.get_smileys();
+	BOOST_CHECK_EQUAL(smileys[":)"].size(), 100);
+	BOOST_CHECK_EQUAL(std::is_sorted(smileys[":)"].begin(), smileys[":)"].end()), true);
+}
+// Testing the per-worker results are merged and accumulated across several batches. 
+BOOST_AUTO_TEST_CASE(TEST_ANALYZE_ENGINE_BATCHES_MERGE)
+{
+	libs::analysis::analyze_stats_engine<std::string, size_t> stats(
+			std::make_unique<libs::analysis::analyze_stats_engine<std::string, size_t>::queue_type>(), 4);
+	for(size_t batch = 0; batch < 2; ++batch) {
+		stats.start();
+		for(size_t i = 0; i < 50; ++i) {
+			std::string text("w" + std::to_string(i) + " common :-]");
+			const size_t length = text.length();
+			stats.submit({std::move(text), (batch * 50 + i + 1) * 100, length});
+		}
+		stats.wait();
+	}
+	std::unordered_map<std::string, size_t> freq = stats.get_map();
+	BOOST_CHECK_EQUAL(freq.size(), 51);
+	BOOST_CHECK_EQUAL(freq["common"], 100);
+	BOOST_CHECK_EQUAL(freq["w7"], 2);
+	std::unordered_map<std::string, std::vector<size_t>> smileys = stats.get_smileys();
+	BOOST_CHECK_EQUAL(smileys[":-]"].size(), 100);
+	BOOST_CHECK_EQUAL(std::is_sorted(smileys[":-]"].begin(), smileys[":-]"].end()), true);
+}
+
+// TESTS WITH MEMORY MAPPED INPUT
+// Testing that the memory mapped reader gives the same result as the stream reader. 
+BOOST_FIXTURE_TEST_CASE(TEST_MAPPED_VS_STREAM, file_op_fixture)
+{
+	libs::proccesing::io_engine<std::string, size_t> mapped("./test/test_files/file.txt", 64);
+	mapped.set_reader(libs::proccesing::reader_type::mapped);
+	obj.read();
+	mapped.read();
+	bool result = (obj.get_map() == mapped.get_map());
+	BOOST_CHECK_EQUAL(result, true);
+	result = (obj.get_smileys_map() == mapped.get_smileys_map());
+	BOOST_CHECK_EQUAL(result, true);
+}
+// Testing the memory mapped reader with the windows smaller than the file. 
+BOOST_FIXTURE_TEST_CASE(TEST_MAPPED_SLIDING_WINDOW, file_op_fixture)
+{
+	libs::proccesing::io_engine<std::string, size_t> mapped("./test/test_files/file.txt", 64);
+	mapped.set_reader(libs::proccesing::reader_type::mapped);
+	mapped.set_mapped_window_size(200);
+	obj.read();
+	mapped.read();
+	bool result = (obj.get_map() == mapped.get_map());
+	BOOST_CHECK_EQUAL(result, true);
+	result = (obj.get_smileys_map() == mapped.get_smileys_map());
+	BOOST_CHECK_EQUAL(result, true);
+}
+// Testing smileys positions with the memory mapped reader. 
+BOOST_AUTO_TEST_CASE(TEST_MAPPED_NO_WORDS)
+{
+	libs::proccesing::io_engine<std::string, size_t> mapped("./test/test_files/no_words_text.txt", 16);
+	mapped.set_reader(libs::proccesing::reader_type::mapped);
+	mapped.read();
+	BOOST_CHECK_EQUAL(mapped.get_map().size(), 0);
+	std::unordered_map<std::string, std::vector<size_t>> golden = {
+		{":-)", {1, 9, 20}}, {":)", {31}},
+		{":]" , {5, 23, 39}}, {":}", {7, 35}},
+		{":-}", {12, 26}}, {":-]",{15}}};
+	bool result = (mapped.get_smileys_map() == golden);
+	BOOST_CHECK_EQUAL(result, true);
+}
+// Testing the reader's error is reported once the workers have stopped, so the engine can be read again.
+BOOST_AUTO_TEST_CASE(TEST_READER_ERROR)
+{
+	const std::filesystem::path path = std::filesystem::temp_directory_path() / "analyze_statistics_reader_error.txt";
+	for(auto reader: {libs::proccesing::reader_type::stream, libs::proccesing::reader_type::mapped, libs::proccesing::reader_type::parallel}) {
+		{
+			std::ofstream os(path);
+			os << "word :)";
+		}
+		libs::proccesing::io_engine<std::string, size_t> missing(path.string(), 16, "", 4);
+		// the file is removed once the engine is created, so the reader fails while the workers are running
+		std::filesystem::remove(path);
+		missing.set_reader(reader);
+		BOOST_CHECK_THROW(missing.read(), libs::exception::custom_exception);
+		BOOST_CHECK_THROW(missing.read(), libs::exception::custom_exception);
+		BOOST_CHECK_EQUAL(missing.get_map().size(), 0);
+	}
+}
+// Testing a token longer than the block and a block without any space are read until their end by every reader.
+BOOST_AUTO_TEST_CASE(TEST_TOKEN_LONGER_THAN_BLOCK)
+{
+	const std::filesystem::path path = std::filesystem::temp_directory_path() / "analyze_statistics_long_token.txt";
+	{
+		std::ofstream os(path);
+		os << "abcdefghijklmnopqrstuvwxyz :) word\nline\nother\nline :)";
+	}
+	const std::unordered_map<std::string, size_t> golden{{"abcdefghijklmnopqrstuvwxyz", 1}, {"word", 1}, {"line", 2}, {"other", 1}};
+	for(auto reader: {libs::proccesing::reader_type::stream, libs::proccesing::reader_type::mapped, 
+			libs::proccesing::reader_type::parallel, libs::proccesing::reader_type::async}) {
+		for(size_t block_size: {1, 3, 4}) {
+			libs::proccesing::io_engine<std::string, size_t> obj(path.string(), block_size, "", 2);
+			obj.set_reader(reader);
+			obj.read();
+			bool result = (obj.get_map() == golden);
+			BOOST_CHECK_EQUAL(result, true);
+			BOOST_CHECK_EQUAL(obj.get_smileys_map()[":)"].size(), 2);
+		}
+	}
+	std::filesystem::remove(path);
+}
+
+// TESTS OF THE FLAT COUNTER
+// Testing the open addressing table gives the same counts as the node based map. 
+BOOST_AUTO_TEST_CASE(TEST_FLAT_COUNTER_VS_UNORDERED_MAP)
+{
+	libs::datastructure::flat_counter<std::string, size_t> counter{};
+	std::unordered_map<std::string, size_t> golden{};
+	for(size_t i = 0; i < 20000; ++i) {
+		std::string word = "w" + std::to_string(i * 7919 % 3001);
+		counter.add(word, i % 3);
+		golden[word] += i % 3;
+	}
+	BOOST_CHECK_EQUAL(counter.size(), golden.size());
+	bool result = (counter.to_map() == golden);
+	BOOST_CHECK_EQUAL(result, true);
+	BOOST_CHECK(counter.find("w1") != nullptr);
+	BOOST_CHECK_EQUAL(*counter.find("w1"), golden["w1"]);
+	BOOST_CHECK(counter.find("missing") == nullptr);
+	libs::datastructure::flat_counter<std::string, size_t> moved(std::move(counter));
+	BOOST_CHECK_EQUAL(counter.size(), 0);
+	BOOST_CHECK_EQUAL(moved.size(), golden.size());
+	libs::datastructure::flat_counter<std::string, size_t> other{};
+	other.add("w1", 5);
+	other.add("extra", 1);
+	moved.merge(other);
+	BOOST_CHECK_EQUAL(moved.size(), golden.size() + 1);
+	BOOST_CHECK_EQUAL(*moved.find("w1"), golden["w1"] + 5);
+	size_t total = 0;
+	for(const auto& [word, freq]: moved) {
+		total += freq;
+	}
+	size_t golden_total = 6;
+	for(auto& [word, freq]: golden) {
+		golden_total += freq;
+	}
+	BOOST_CHECK_EQUAL(total, golden_total);
+}
+
+// TESTS OF THE TOKENIZER
+// Testing the table driven split keeps the semantics of boost::split. 
+BOOST_AUTO_TEST_CASE(TEST_SPLIT_VS_BOOST_SPLIT)
+{
+	std::vector<std::string> inputs = {"", ",", ",,,", "word", " word", "word ", "one, two;;three",
+		":-) smile :] (brackets) \t\nnew line", "a--b->c", "don't stop=go|run_fast\\"};
+	for(auto& input: inputs) {
+		for(auto mode: {boost::token_compress_on, boost::token_compress_off}) {
+			std::vector<std::string> golden{};
+			boost::split(golden, input, boost::is_any_of(libs::utils::special_characters), mode);
+			std::vector<std::string> words = libs::utils::split_by_any_of_special_character(input, mode);
+			BOOST_CHECK_EQUAL_COLLECTIONS(words.begin(), words.end(), golden.begin(), golden.end());
+		}
+	}
+}
+// Testing the allocation free tokenizer yields the non-empty tokens of the split. 
+BOOST_AUTO_TEST_CASE(TEST_FOR_EACH_WORD)
+{
+	std::ifstream is("./test/test_files/file.txt");
+	std::string text((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+	std::vector<std::string> golden{};
+	for(auto& word: libs::utils::split_by_any_of_special_character(text)) {
+		if(!word.empty()) {
+			golden.push_back(word);
+		}
+	}
+	std::vector<std::string> words{};
+	libs::utils::for_each_word(text, [&words](std::string_view word) {
+			words.emplace_back(word);
+			});
+	BOOST_CHECK_EQUAL_COLLECTIONS(words.begin(), words.end(), golden.begin(), golden.end());
+}
+
+// TESTS OF THE SMILEYS SCANNER
+// Testing the scanner finds the same smileys at the same positions as the regular expression. 
+BOOST_AUTO_TEST_CASE(TEST_SMILEYS_SCANNER_VS_REGEX)
+{
+	std::ifstream is("./test/test_files/file.txt");
+	std::string file_text((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+	std::vector<std::string> inputs = {file_text, "", ":", ":-", ":-:)", "::-)", ":--)", ":-)-:]", "a:)b:(c:{d:[e:}f:]", ":-(:-{:-[:-}"};
+	const std::regex pat("(:-?(\\)|\\}|\\]|\\(|\\{|\\[))");
+	for(auto& input: inputs) {
+		std::unordered_map<std::string, std::vector<size_t>> golden{};
+		for(std::sregex_iterator it(input.cbegin(), input.cend(), pat); it != std::sregex_iterator(); ++it) {
+			golden[it->str()].push_back(100 - input.size() + it->position() + 1);
+		}
+		std::unordered_map<std::string, std::vector<size_t>> smileys{};
+		libs::utils::search_smileys<std::string, size_t>(input, 100, smileys);
+		bool result = (smileys == golden);
+		BOOST_CHECK_EQUAL(result, true);
+	}
+}
+// Testing the additional emoticons. 
+BOOST_AUTO_TEST_CASE(TEST_CUSTOM_SMILEYS)
+{
+	libs::utils::smiley_set set = libs::utils::smiley_set::defaults();
+	set.add(";)");
+	set.add(":D");
+	set.add(":-D");
+	std::unordered_map<std::string, std::vector<size_t>> smileys{};
+	libs::utils::search_smileys<std::string, size_t>(std::string_view(";) :D :-D :) ;-)"), 16, smileys, set);
+	std::unordered_map<std::string, std::vector<size_t>> golden = {
+		{";)", {1}}, {":D", {4}}, {":-D", {7}}, {":)", {11}}};
+	bool result = (smileys == golden);
+	BOOST_CHECK_EQUAL(result, true);
+}
+
+// TESTS OF THE FUSED KERNEL
+// Testing the single pass kernel gives the same words and smileys as the separate passes. 
+BOOST_AUTO_TEST_CASE(TEST_FUSED_KERNEL_VS_SPLIT)
+{
+	std::ifstream is("./test/test_files/file.txt");
+	std::string file_text((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+	libs::utils::smiley_set set = libs::utils::smiley_set::defaults();
+	set.add(":D");
+	std::vector<std::string> inputs = {file_text, "", ":-:)", "word:Dword", "a:)b :-]c", "::-)x"};
+	for(auto& input: inputs) {
+		std::vector<std::string> golden_words{};
+		libs::utils::for_each_word(input, [&golden_words](std::string_view word) {
+				golden_words.emplace_back(word);
+				});
+		std::vector<std::pair<size_t, std::string>> golden_smileys{};
+		set.scan(input, [&golden_smileys](size_t offset, std::string_view code) {
+				golden_smileys.emplace_back(offset, code);
+				});
+		std::vector<std::string> words{};
+		std::vector<std::pair<size_t, std::string>> smileys{};
+		libs::utils::for_each_word_and_smiley(input, set, 
+				[&words](std::string_view word) {
+				words.emplace_back(word);
+				},
+				[&smileys](size_t offset, std::string_view code) {
+				smileys.emplace_back(offset, code);
+				});
+		BOOST_CHECK_EQUAL_COLLECTIONS(words.begin(), words.end(), golden_words.begin(), golden_words.end());
+		bool result = (smileys == golden_smileys);
+		BOOST_CHECK_EQUAL(result, true);
+	}
+}
+// Testing the engine gives the same result with both kernels. 
+BOOST_FIXTURE_TEST_CASE(TEST_ENGINE_KERNELS, file_op_fixture)
+{
+	libs::proccesing::io_engine<std::string, size_t> fused("./test/test_files/file.txt", 64);
+	fused.set_kernel(libs::analysis::analysis_kernel::fused);
+	obj.read();
+	fused.read();
+	bool result = (obj.get_map() == fused.get_map());
+	BOOST_CHECK_EQUAL(result, true);
+	result = (obj.get_smileys_map() == fused.get_smileys_map());
+	BOOST_CHECK_EQUAL(result, true);
+}
+
+// TESTS OF THE BATCHED DATABASE WRITES
+// Testing the database holds the same counts and smileys positions as the ram-memory whatever the batch size is. 
+BOOST_AUTO_TEST_CASE(TEST_DB_BATCHES_VS_MEMORY)
+{
+	libs::proccesing::io_engine<std::string, size_t> memory("./test/test_files/file.txt", 64);
+	memory.read();
+	std::unordered_map<std::string, size_t> golden = memory.get_map();
+	std::unordered_map<std::string, std::vector<size_t>> golden_smileys = memory.get_smileys_map();
+	for(size_t batch: {1, 7, 1000}) {
+		libs::proccesing::io_engine<std::string, size_t> db("./test/test_files/file.txt", 64, "test_db.db", 3);
+		db.set_db_batch_size(batch);
+		db.read();
+		std::vector<std::pair<std::string, std::string>> response = 
+			db.query_n_most_frequent(golden.size(), [](size_t n){return std::to_string(n);});
+		std::unordered_map<std::string, size_t> freq{};
+		for(size_t i = 0; i < response.size(); i += 2) {
+			freq[response[i].second] = std::stoul(response[i + 1].second);
+		}
+		bool result = (freq == golden);
+		BOOST_CHECK_EQUAL(result, true);
+		std::vector<std::pair<std::string, std::string>> rows = db.get_smileys([](size_t n){return std::to_string(n);});
+		std::unordered_map<std::string, std::vector<size_t>> smileys{};
+		for(size_t i = 0; i < rows.size(); i += 2) {
+			std::istringstream positions(rows[i + 1].second);
+			size_t pos = 0;
+			while(positions >> pos) {
+				smileys[rows[i].second].push_back(pos);
+			}
+			std::sort(smileys[rows[i].second].begin(), smileys[rows[i].second].end());
+		}
+		result = (smileys == golden_smileys);
+		BOOST_CHECK_EQUAL(result, true);
+	}
+}
+
+// TESTS OF THE EXTERNAL AGGREGATION
+// Testing the runs are merged by the word order and the equal words of the different runs are summed up.
+BOOST_AUTO_TEST_CASE(TEST_SPILL_AGGREGATOR_MERGE)
+{
+	const std::string spill_dir = (std::filesystem::temp_directory_path() / "analyze_statistics_spill").string();
+	libs::proccesing::spill_aggregator<std::string, size_t> spill(spill_dir);
+	libs::datastructure::flat_counter<std::string, size_t> first{};
+	first.add("beta", 2);
+	first.add("alpha", 1);
+	first.add("gamma", 5);
+	libs::datastructure::flat_counter<std::string, size_t> second{};
+	second.add("beta", 3);
+	second.add("delta", 5);
+	spill.spill(first);
+	spill.spill(second);
+	BOOST_CHECK_EQUAL(spill.runs_count(), 2);
+	std::vector<std::pair<std::string, size_t>> merged{};
+	spill.for_each([&merged](std::string_view word, size_t freq) {
+			merged.emplace_back(std::string(word), freq);
+			});
+	std::vector<std::pair<std::string, size_t>> expected{{"alpha", 1}, {"beta", 5}, {"delta", 5}, {"gamma", 5}};
+	bool result = (merged == expected);
+	BOOST_CHECK_EQUAL(result, true);
+	std::vector<std::pair<std::string, size_t>> top = spill.top_n(3);
+	expected = {{"beta", 5}, {"delta", 5}, {"gamma", 5}};
+	result = (top == expected);
+	BOOST_CHECK_EQUAL(result, true);
+	spill.clear();
+	BOOST_CHECK_EQUAL(spill.runs_count(), 0);
+}
+
+// Testing the spilled counts are the same as the ram-memory ones even if every chunk is spilled.
+BOOST_AUTO_TEST_CASE(TEST_SPILL_VS_MEMORY)
+{
+	libs::proccesing::io_engine<std::string, size_t> memory("./test/test_files/file.txt", 64);
+	memory.read();
+	std::unordered_map<std::string, size_t> golden = memory.get_map();
+	const std::string spill_dir = (std::filesystem::temp_directory_path() / "analyze_statistics_spill").string();
+	for(size_t budget: {size_t(1), size_t(64 * 1024 * 1024)}) {
+		libs::proccesing::io_engine<std::string, size_t> spilled("./test/test_files/file.txt", 64, "", 3);
+		spilled.set_spill(spill_dir, budget);
+		spilled.read();
+		BOOST_CHECK(spilled.get_spilled_runs_count() > 0);
+		bool result = (spilled.get_map() == golden);
+		BOOST_CHECK_EQUAL(result, true);
+		result = (spilled.get_smileys_map() == memory.get_smileys_map());
+		BOOST_CHECK_EQUAL(result, true);
+		std::vector<std::pair<std::string, std::string>> response = 
+			spilled.query_n_most_frequent(10, [](size_t n){return std::to_string(n);});
+		BOOST_CHECK_EQUAL(response.size(), 20);
+		for(size_t i = 0; i < response.size(); i += 2) {
+			BOOST_CHECK_EQUAL(std::stoul(response[i + 1].second), golden[response[i].second]);
+		}
+	}
+	// the budget of a single byte spills every chunk, more than the merge fan-in
+	libs::proccesing::io_engine<std::string, size_t> spilled("./test/test_files/file.txt", 16, "", 1);
+	spilled.set_spill(spill_dir, 1);
+	spilled.set_reader(libs::proccesing::reader_type::mapped);
+	spilled.read();
+	const size_t max_fan_in = libs::proccesing::spill_aggregator<std::string, size_t>::max_fan_in;
+	BOOST_CHECK(spilled.get_spilled_runs_count() > max_fan_in);
+	bool result = (spilled.get_map() == golden);
+	BOOST_CHECK_EQUAL(result, true);
+}
+
+// TESTS OF THE TOP-N SELECTION
+// Testing the sharded selection returns the same entries as sorting the whole table, the ties are ordered alphabetically.
+BOOST_AUTO_TEST_CASE(TEST_COUNTER_TOP_N)
+{
+	libs::datastructure::flat_counter<std::string, size_t> counter{};
+	std::vector<std::pair<std::string, size_t>> all{};
+	for(size_t i = 0; i < 200000; ++i) {
+		const std::string word = "w" + std::to_string(i);
+		counter.add(word, i % 1000);
+		all.emplace_back(word, i % 1000);
+	}
+	std::sort(all.begin(), all.end(), [](const auto& lhs, const auto& rhs) {
+			return lhs.second != rhs.second ? lhs.second > rhs.second : lhs.first < rhs.first;
+			});
+	for(size_t shards: {1, 4}) {
+		std::vector<std::pair<std::string_view, size_t>> top = counter.top_n(500, shards);
+		BOOST_CHECK_EQUAL(top.size(), 500);
+		bool result = true;
+		for(size_t i = 0; i < top.size(); ++i) {
+			result = result && top[i].first == all[i].first && top[i].second == all[i].second;
+		}
+		BOOST_CHECK_EQUAL(result, true);
+	}
+	BOOST_CHECK_EQUAL(counter.top_n(0).size(), 0);
+	BOOST_CHECK_EQUAL(counter.top_n(300000, 4).size(), 200000);
+}
+// Testing the tracked top stays the same as the selection from the whole table while the counters grow.
+BOOST_AUTO_TEST_CASE(TEST_TOP_N_TRACKER)
+{
+	libs::datastructure::flat_counter<std::string, size_t> counter{};
+	libs::datastructure::top_n_tracker<size_t> tracker(20);
+	bool result = true;
+	for(size_t i = 0; i < 50000; ++i) {
+		const std::string word = "w" + std::to_string((i * 7919) % 997);
+		const size_t* previous = counter.find(word);
+		const size_t before = previous == nullptr ? 0 : *previous;
+		counter.add(word, i % 13 + 1);
+		tracker.update(word, before, before + i % 13 + 1);
+		if(i % 1000 == 0 || i + 1 == 50000) {
+			const auto expected = counter.top_n(20);
+			const auto top = tracker.top(20);
+			result = result && top == expected;
+		}
+	}
+	BOOST_CHECK_EQUAL(result, true);
+	BOOST_CHECK_EQUAL(tracker.top(5).size(), 5);
+	tracker.clear();
+	BOOST_CHECK_EQUAL(tracker.top(5).size(), 0);
+}
+
+// Testing the word which frequency isn't less than the number of the words, i.e. a single word.
+BOOST_AUTO_TEST_CASE(TEST_TOP_N_SINGLE_WORD)
+{
+	libs::proccesing::io_engine<std::string, size_t> obj("./test/test_files/just_one_word.txt", 64);
+	obj.read();
+	std::vector<std::pair<std::string, std::string>> response = 
+		obj.query_n_most_frequent(10, [](size_t n){return std::to_string(n);});
+	BOOST_CHECK_EQUAL(response.size(), 2);
+	BOOST_CHECK_EQUAL(response[0].second, "Hello");
+	BOOST_CHECK_EQUAL(response[1].second, "1");
+}
+
+// TESTS OF THE RING BUFFER
+// Testing the capacity is rounded up, the try variants don't block and the tasks are handed out in order.
+BOOST_AUTO_TEST_CASE(TEST_RING_BUFFER_TRY)
+{
+	libs::safe_datastructure::mpmc_ring_buffer<std::string, size_t> queue(3);
+	BOOST_CHECK_EQUAL(queue.capacity(), 4);
+	for(size_t i = 0; i < 4; ++i) {
+		BOOST_CHECK_EQUAL(queue.try_push({std::to_string(i), i, 1}), true);
+	}
+	std::tuple<std::string, size_t, size_t> rejected{"4", 4, 1};
+	BOOST_CHECK_EQUAL(queue.try_push(std::move(rejected)), false);
+	BOOST_CHECK_EQUAL(std::get<0>(rejected), "4");
+	BOOST_CHECK_EQUAL(queue.size(), 4);
+	for(size_t i = 0; i < 4; ++i) {
+		auto task = queue.try_pop();
+		BOOST_CHECK_EQUAL(task.has_value(), true);
+		BOOST_CHECK_EQUAL(std::get<1>(*task), i);
+	}
+	BOOST_CHECK_EQUAL(queue.try_pop().has_value(), false);
+	BOOST_CHECK_EQUAL(queue.empty(), true);
+}
+
+// Testing the closed queue is drained by the consumers before they are released.
+BOOST_AUTO_TEST_CASE(TEST_RING_BUFFER_CLOSE_DRAIN)
+{
+	libs::safe_datastructure::mpmc_ring_buffer<std::string, size_t> queue(8);
+	queue.push({"a", 1, 1});
+	queue.push({"b", 2, 1});
+	queue.close();
+	BOOST_CHECK_EQUAL(queue.push({"c", 3, 1}), false);
+	BOOST_CHECK_EQUAL(std::get<0>(*queue.wait_and_pop()), "a");
+	BOOST_CHECK_EQUAL(std::get<0>(*queue.wait_and_pop()), "b");
+	BOOST_CHECK_EQUAL(queue.wait_and_pop().has_value(), false);
+	queue.reopen();
+	BOOST_CHECK_EQUAL(queue.push({"d", 4, 1}), true);
+	BOOST_CHECK_EQUAL(std::get<0>(*queue.wait_and_pop()), "d");
+}
+
+// Testing every task is consumed exactly once by several producers and consumers through a tiny ring.
+BOOST_AUTO_TEST_CASE(TEST_RING_BUFFER_MPMC)
+{
+	const size_t producers = 4;
+	const size_t consumers = 4;
+	const size_t tasks = 20000;
+	libs::safe_datastructure::mpmc_ring_buffer<std::string, size_t> queue(4);
+	std::vector<size_t> seen(producers * tasks, 0);
+	std::vector<std::thread> consumer_threads{};
+	for(size_t c = 0; c < consumers; ++c) {
+		consumer_threads.emplace_back([&queue, &seen]() {
+				while(auto task = queue.wait_and_pop()) {
+					++seen[std::get<1>(*task)];
+				}
+				});
+	}
+	std::vector<std::thread> producer_threads{};
+	for(size_t p = 0; p < producers; ++p) {
+		producer_threads.emplace_back([&queue, p, tasks]() {
+				for(size_t i = 0; i < tasks; ++i) {
+					queue.push({"task", p * tasks + i, 4});
+				}
+				});
+	}
+	for(auto& thread: producer_threads) {
+		thread.join();
+	}
+	queue.close();
+	for(auto& thread: consumer_threads) {
+		thread.join();
+	}
+	bool result = std::all_of(seen.begin(), seen.end(), [](size_t count) {return count == 1;});
+	BOOST_CHECK_EQUAL(result, true);
+}
+
+// TESTS OF THE WORK STEALING SCHEDULER
+// Testing a fast worker steals the tasks of a slow one and every task is executed exactly once.
+BOOST_AUTO_TEST_CASE(TEST_WORK_STEALING_QUEUE)
+{
+	const size_t tasks = 100;
+	libs::safe_datastructure::work_stealing_queue<size_t> queue(2, tasks);
+	for(size_t i = 0; i < tasks; ++i) {
+		queue.push(size_t(i));
+	}
+	queue.close();
+	std::vector<size_t> seen(tasks, 0);
+	std::vector<std::thread> workers{};
+	for(size_t id = 0; id < 2; ++id) {
+		workers.emplace_back([&queue, &seen, id]() {
+				while(auto task = queue.pop(id)) {
+					++seen[*task];
+					if(id == 0) {
+						std::this_thread::sleep_for(std::chrono::milliseconds(1));
+					}
+				}
+				});
+	}
+	for(auto& worker: workers) {
+		worker.join();
+	}
+	bool result = std::all_of(seen.begin(), seen.end(), [](size_t count) {return count == 1;});
+	BOOST_CHECK_EQUAL(result, true);
+	std::vector<libs::safe_datastructure::worker_stats> stats = queue.get_stats();
+	BOOST_CHECK_EQUAL(stats[0].executed + stats[1].executed, tasks);
+	BOOST_CHECK(stats[1].steals > 0);
+	BOOST_CHECK(stats[1].executed > stats[0].executed);
+}
+
+// Testing the results of the work stealing scheduler are the same as of the shared queue.
+BOOST_AUTO_TEST_CASE(TEST_WORK_STEALING_VS_SHARED_QUEUE)
+{
+	libs::proccesing::io_engine<std::string, size_t> shared("./test/test_files/file.txt", 64, "", 3);
+	shared.read();
+	BOOST_CHECK_EQUAL(shared.get_scheduler_stats().empty(), true);
+	libs::proccesing::io_engine<std::string, size_t> stealing("./test/test_files/file.txt", 64, "", 3);
+	stealing.set_scheduler(libs::analysis::scheduler_type::work_stealing);
+	stealing.read();
+	bool result = (shared.get_map() == stealing.get_map());
+	BOOST_CHECK_EQUAL(result, true);
+	result = (shared.get_smileys_map() == stealing.get_smileys_map());
+	BOOST_CHECK_EQUAL(result, true);
+	std::vector<libs::safe_datastructure::worker_stats> stats = stealing.get_scheduler_stats();
+	BOOST_CHECK_EQUAL(stats.size(), 3);
+	size_t executed = 0;
+	for(auto& worker: stats) {
+		executed += worker.executed;
+	}
+	BOOST_CHECK(executed > 0);
+}
+
+// TESTS WITH THE PARALLEL READER
+// Testing the ranges read concurrently give the same counts and smileys positions as the stream reader whatever the split is. 
+BOOST_FIXTURE_TEST_CASE(TEST_PARALLEL_VS_STREAM, file_op_fixture)
+{
+	obj.read();
+	for(size_t block: {8, 64, 4096}) {
+		for(size_t readers: {1, 2, 3, 7, 64}) {
+			libs::proccesing::io_engine<std::string, size_t> parallel("./test/test_files/file.txt", block, "", 2);
+			parallel.set_reader(libs::proccesing::reader_type::parallel);
+			parallel.set_readers_count(readers);
+			parallel.read();
+			bool result = (obj.get_map() == parallel.get_map());
+			BOOST_CHECK_EQUAL(result, true);
+			result = (obj.get_smileys_map() == parallel.get_smileys_map());
+			BOOST_CHECK_EQUAL(result, true);
+		}
+	}
+}
+// Testing the parallel reader with the inputs without any space. 
+BOOST_AUTO_TEST_CASE(TEST_PARALLEL_NO_SPACES)
+{
+	for(const std::string file: {"./test/test_files/just_one_smyle.txt", "./test/test_files/just_one_word.txt", "./test/test_files/empty.txt"}) {
+		libs::proccesing::io_engine<std::string, size_t> mapped(file, 2);
+		mapped.set_reader(libs::proccesing::reader_type::mapped);
+		mapped.read();
+		libs::proccesing::io_engine<std::string, size_t> parallel(file, 2, "", 2);
+		parallel.set_reader(libs::proccesing::reader_type::parallel);
+		parallel.set_readers_count(4);
+		parallel.read();
+		bool result = (mapped.get_map() == parallel.get_map());
+		BOOST_CHECK_EQUAL(result, true);
+		result = (mapped.get_smileys_map() == parallel.get_smileys_map());
+		BOOST_CHECK_EQUAL(result, true);
+	}
+}
+
+// TESTS OF THE ADAPTIVE CHUNK SIZE
+// Testing the size grows towards the target only while the workers are behind and shrinks when they are slow.
+BOOST_AUTO_TEST_CASE(TEST_CHUNK_SIZE_CONTROLLER)
+{
+	using controller = libs::proccesing::chunk_size_controller;
+	controller sizer(64 * 1024, 4 * 1024, 1024 * 1024, std::chrono::milliseconds(1));
+	BOOST_CHECK_EQUAL(sizer.size(), 64 * 1024);
+	// nothing has been processed yet
+	BOOST_CHECK_EQUAL(sizer.update(0, 0, std::chrono::nanoseconds(0), 0, 16), 64 * 1024);
+	// 1 byte per ns means 1 MB per ms, the queue is empty, so the size doesn't grow
+	size_t chunks = 0;
+	size_t bytes = 0;
+	std::chrono::nanoseconds busy(0);
+	auto step = [&](size_t rate_bytes_per_us, size_t depth) {
+		chunks += 1;
+		bytes += 64 * 1024;
+		busy += std::chrono::microseconds(64 * 1024 / rate_bytes_per_us);
+		return sizer.update(chunks, bytes, busy, depth, 16);
+	};
+	BOOST_CHECK_EQUAL(step(1000, 0), 64 * 1024);
+	// the queue is full, the size approaches the upper bound
+	size_t size = 0;
+	for(size_t i = 0; i < 64; ++i) {
+		size = step(1000, 16);
+	}
+	BOOST_CHECK(size > 512 * 1024);
+	BOOST_CHECK(size <= 1024 * 1024);
+	BOOST_CHECK_EQUAL(size % controller::alignment, 0);
+	// the workers slow down to 10 bytes per us, i.e. 10 KB per ms
+	for(size_t i = 0; i < 64; ++i) {
+		size = step(10, 0);
+	}
+	BOOST_CHECK(size < 16 * 1024);
+	BOOST_CHECK(size >= 4 * 1024);
+	BOOST_CHECK_EQUAL(sizer.largest() > 512 * 1024, true);
+	BOOST_CHECK_EQUAL(sizer.smallest(), size);
+	BOOST_CHECK(sizer.adjustments() > 0);
+}
+
+// Testing the adaptive size gives the same results as the fixed one with every reader.
+BOOST_FIXTURE_TEST_CASE(TEST_ADAPTIVE_CHUNK_SIZE, file_op_fixture)
+{
+	obj.read();
+	BOOST_CHECK_EQUAL(obj.get_chunk_size_controller() == nullptr, true);
+	for(auto reader: {libs::proccesing::reader_type::stream, libs::proccesing::reader_type::mapped, libs::proccesing::reader_type::parallel}) {
+		libs::proccesing::io_engine<std::string, size_t> adaptive("./test/test_files/file.txt", 64, "", 2);
+		adaptive.set_reader(reader);
+		adaptive.set_adaptive_block_size(true);
+		adaptive.read();
+		bool result = (obj.get_map() == adaptive.get_map());
+		BOOST_CHECK_EQUAL(result, true);
+		result = (obj.get_smileys_map() == adaptive.get_smileys_map());
+		BOOST_CHECK_EQUAL(result, true);
+		BOOST_CHECK_EQUAL(adaptive.get_chunk_size_controller() != nullptr, true);
+		BOOST_CHECK(adaptive.get_block_size() >= libs::proccesing::chunk_size_controller::default_min_size);
+	}
+}
+
+// TESTS OF THE ASYNCHRONOUS READER
+// Testing the blocks are handed out in the file order with every backend, the buffered and the direct reads.
+BOOST_AUTO_TEST_CASE(TEST_ASYNC_FILE_READER)
+{
+	const std::filesystem::path path = std::filesystem::temp_directory_path() / "async_file_reader_test.txt";
+	std::string text{};
+	for(size_t i = 0; text.size() < 50000; ++i) {
+		text += "word" + std::to_string(i % 97) + " :) ";
+	}
+	{
+		std::ofstream os(path, std::ios::binary);
+		os << text;
+	}
+	for(auto backend: {libs::proccesing::async_backend::io_uring, libs::proccesing::async_backend::pread}) {
+		for(bool direct: {true, false}) {
+			for(size_t depth: {1, 2, 5}) {
+				libs::proccesing::async_file_reader file(path.string(), 4096, depth, backend, direct);
+				BOOST_CHECK_EQUAL(file.size(), text.size());
+				BOOST_CHECK_EQUAL(file.block_size(), libs::proccesing::async_file_reader::alignment);
+				std::string read{};
+				size_t blocks = 0;
+				while(std::optional<std::string_view> data = file.next()) {
+					read.append(data.value());
+					++blocks;
+				}
+				BOOST_CHECK_EQUAL(blocks, (text.size() + 4095) / 4096);
+				BOOST_CHECK_EQUAL(read == text, true);
+				BOOST_CHECK_EQUAL(file.next().has_value(), false);
+			}
+		}
+	}
+	libs::proccesing::async_file_reader empty("./test/test_files/empty.txt");
+	BOOST_CHECK_EQUAL(empty.next().has_value(), false);
+	std::filesystem::remove(path);
+}
+
+// Testing the asynchronous reader gives the same results as the stream reader.
+BOOST_FIXTURE_TEST_CASE(TEST_ASYNC_VS_STREAM, file_op_fixture)
+{
+	obj.read();
+	for(auto backend: {libs::proccesing::async_backend::io_uring, libs::proccesing::async_backend::pread}) {
+		for(size_t block: {8, 64, 4096}) {
+			libs::proccesing::io_engine<std::string, size_t> async("./test/test_files/file.txt", block, "", 2);
+			async.set_reader(libs::proccesing::reader_type::async);
+			async.set_async_io(backend, 2);
+			async.read();
+			bool result = (obj.get_map() == async.get_map());
+			BOOST_CHECK_EQUAL(result, true);
+			result = (obj.get_smileys_map() == async.get_smileys_map());
+			BOOST_CHECK_EQUAL(result, true);
+		}
+	}
+	for(const std::string file: {"./test/test_files/just_one_smyle.txt", "./test/test_files/just_one_word.txt", "./test/test_files/empty.txt"}) {
+		libs::proccesing::io_engine<std::string, size_t> mapped(file, 2);
+		mapped.set_reader(libs::proccesing::reader_type::mapped);
+		mapped.read();
+		libs::proccesing::io_engine<std::string, size_t> async(file, 2);
+		async.set_reader(libs::proccesing::reader_type::async);
+		async.read();
+		bool result = (mapped.get_map() == async.get_map());
+		BOOST_CHECK_EQUAL(result, true);
+		result = (mapped.get_smileys_map() == async.get_smileys_map());
+		BOOST_CHECK_EQUAL(result, true);
+	}
+}
+
+// TESTS OF THE STREAMED INPUT
+// Testing the forward reader gives the same results as the stream reader for the regular files.
+BOOST_FIXTURE_TEST_CASE(TEST_FORWARD_VS_STREAM, file_op_fixture)
+{
+	obj.read();
+	BOOST_CHECK_EQUAL(obj.is_streamed(), false);
+	for(size_t block: {1, 8, 64, 4096}) {
+		libs::proccesing::io_engine<std::string, size_t> forward("./test/test_files/file.txt", block, "", 2);
+		forward.set_reader(libs::proccesing::reader_type::forward);
+		forward.read();
+		bool result = (obj.get_map() == forward.get_map());
+		BOOST_CHECK_EQUAL(result, true);
+		result = (obj.get_smileys_map() == forward.get_smileys_map());
+		BOOST_CHECK_EQUAL(result, true);
+	}
+}
+
+// Testing a pipe is read forward whichever reader is selected.
+BOOST_FIXTURE_TEST_CASE(TEST_FIFO_INPUT, file_op_fixture)
+{
+	obj.read();
+	const std::filesystem::path fifo = std::filesystem::temp_directory_path() / "analyze_statistics_test.fifo";
+	std::filesystem::remove(fifo);
+	BOOST_REQUIRE_EQUAL(mkfifo(fifo.c_str(), 0600), 0);
+	std::ifstream is("./test/test_files/file.txt", std::ios::binary);
+	const std::string text((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+	for(auto reader: {libs::proccesing::reader_type::stream, libs::proccesing::reader_type::mapped, libs::proccesing::reader_type::async}) {
+		std::thread writer([&fifo, &text]() {
+				std::ofstream os(fifo, std::ios::binary);
+				// the pipe gets the text in small pieces, the way a decompressor writes it
+				for(size_t i = 0; i < text.size(); i += 100) {
+					os.write(text.data() + i, std::min<size_t>(100, text.size() - i));
+					os.flush();
+				}
+				});
+		libs::proccesing::io_engine<std::string, size_t> piped(fifo.string(), 64, "", 2);
+		BOOST_CHECK_EQUAL(piped.is_streamed(), true);
+		piped.set_reader(reader);
+		piped.read();
+		writer.join();
+		bool result = (obj.get_map() == piped.get_map());
+		BOOST_CHECK_EQUAL(result, true);
+		result = (obj.get_smileys_map() == piped.get_smileys_map());
+		BOOST_CHECK_EQUAL(result, true);
+	}
+	std::filesystem::remove(fifo);
+}
+
+#if defined(_ZLIB_)
+// TESTS OF THE COMPRESSED INPUT
+/*
+ * Compresses the text as a gzip member.
+ */
+static std::string gzip_compress(const std::string& text) {
+	z_stream zs{};
+	BOOST_REQUIRE_EQUAL(deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY), Z_OK);
+	std::string ret(deflateBound(&zs, text.size()), '\0');
+	zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(text.data()));
+	zs.avail_in = text.size();
+	zs.next_out = reinterpret_cast<Bytef*>(ret.data());
+	zs.avail_out = ret.size();
+	BOOST_REQUIRE_EQUAL(deflate(&zs, Z_FINISH), Z_STREAM_END);
+	ret.resize(zs.total_out);
+	deflateEnd(&zs);
+	return ret;
+}
+
+// Testing the gzip input, also the one of several members, gives the same results as the plain text with every reader.
+BOOST_FIXTURE_TEST_CASE(TEST_GZIP_INPUT, file_op_fixture)
+{
+	obj.read();
+	std::ifstream is("./test/test_files/file.txt", std::ios::binary);
+	const std::string text((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+	const std::filesystem::path path = std::filesystem::temp_directory_path() / "analyze_statistics_test.txt.gz";
+	for(const std::string& compressed: {gzip_compress(text), gzip_compress(text.substr(0, 1000)) + gzip_compress(text.substr(1000))}) {
+		{
+			std::ofstream os(path, std::ios::binary);
+			os << compressed;
+		}
+		for(auto reader: {libs::proccesing::reader_type::stream, libs::proccesing::reader_type::mapped, libs::proccesing::reader_type::parallel}) {
+			libs::proccesing::io_engine<std::string, size_t> gzipped(path.string(), 64, "", 2);
+			gzipped.set_reader(reader);
+			gzipped.read();
+			BOOST_CHECK_EQUAL(gzipped.get_compression() == libs::proccesing::compression_type::gzip, true);
+			bool result = (obj.get_map() == gzipped.get_map());
+			BOOST_CHECK_EQUAL(result, true);
+			result = (obj.get_smileys_map() == gzipped.get_smileys_map());
+			BOOST_CHECK_EQUAL(result, true);
+		}
+	}
+	BOOST_CHECK_EQUAL(obj.get_compression() == libs::proccesing::compression_type::none, true);
+	// the decoder reads the input by pieces smaller than a gzip block
+	std::istringstream compressed_is(gzip_compress(text));
+	libs::proccesing::decoding_streambuf decoded(compressed_is.rdbuf(), 16);
+	std::istream decoded_is(&decoded);
+	const std::string decoded_text((std::istreambuf_iterator<char>(decoded_is)), std::istreambuf_iterator<char>());
+	BOOST_CHECK_EQUAL(decoded_text == text, true);
+	// a truncated input is an error
+	{
+		const std::string compressed = gzip_compress(text);
+		std::ofstream os(path, std::ios::binary);
+		os << compressed.substr(0, compressed.size() / 2);
+	}
+	libs::proccesing::io_engine<std::string, size_t> truncated(path.string(), 64, "", 2);
+	BOOST_CHECK_THROW(truncated.read(), libs::exception::custom_exception);
+	std::filesystem::remove(path);
+}
+#endif
+
+// TESTS OF THE SEVERAL INPUT FILES
+// Testing the directories and the patterns are expanded into the sorted lists of the files.
+BOOST_AUTO_TEST_CASE(TEST_EXPAND_INPUT_PATHS)
+{
+	const std::filesystem::path dir = std::filesystem::temp_directory_path() / "analyze_statistics_inputs";
+	std::filesystem::remove_all(dir);
+	std::filesystem::create_directories(dir / "nested");
+	for(const std::string name: {"b.log", "a.log", "c.txt"}) {
+		std::ofstream os(dir / name);
+		os << "text";
+	}
+	std::vector<std::string> paths = libs::utils::expand_input_paths({dir.string()});
+	std::vector<std::string> expected{(dir / "a.log").string(), (dir / "b.log").string(), (dir / "c.txt").string()};
+	BOOST_CHECK_EQUAL_COLLECTIONS(paths.begin(), paths.end(), expected.begin(), expected.end());
+	paths = libs::utils::expand_input_paths({(dir / "*.log").string(), "./test/test_files/file.txt", (dir / "*.none").string()});
+	expected = {(dir / "a.log").string(), (dir / "b.log").string(), "./test/test_files/file.txt"};
+	BOOST_CHECK_EQUAL_COLLECTIONS(paths.begin(), paths.end(), expected.begin(), expected.end());
+	std::filesystem::remove_all(dir);
+}
+
+// Testing several files are counted together and the smiley positions are qualified by the file.
+BOOST_AUTO_TEST_CASE(TEST_SEVERAL_INPUTS)
+{
+	const std::vector<std::string> files{"./test/test_files/file.txt", "./test/test_files/no_smyles_text.txt", 
+		"./test/test_files/just_one_smyle.txt", "./test/test_files/empty.txt", "./test/test_files/file.txt"};
+	std::unordered_map<std::string, size_t> expected_words{};
+	std::vector<std::unordered_map<std::string, std::vector<size_t>>> expected_smileys{};
+	for(const auto& file: files) {
+		libs::proccesing::io_engine<std::string, size_t> single(file, 64, "", 2);
+		single.read();
+		for(const auto& [word, freq]: single.get_map()) {
+			expected_words[word] += freq;
+		}
+		expected_smileys.push_back(single.get_smileys_map());
+	}
+	for(size_t readers: {1, 2, 8}) {
+		libs::proccesing::io_engine<std::string, size_t> several(files, 64, "", 2);
+		several.set_readers_count(readers);
+		several.read();
+		bool result = (several.get_map() == expected_words);
+		BOOST_CHECK_EQUAL(result, true);
+		std::vector<std::unordered_map<std::string, std::vector<size_t>>> smileys(files.size());
+		for(const auto& [code, positions]: several.get_smileys_map()) {
+			for(const auto pos: positions) {
+				const auto [input, local] = several.split_position(pos);
+				BOOST_REQUIRE(input < files.size());
+				smileys[input][code].push_back(local);
+			}
+		}
+		for(size_t i = 0; i < files.size(); ++i) {
+			for(auto& [code, positions]: smileys[i]) {
+				std::sort(positions.begin(), positions.end());
+			}
+			for(auto& [code, positions]: expected_smileys[i]) {
+				std::sort(positions.begin(), positions.end());
+			}
+			result = (smileys[i] == expected_smileys[i]);
+			BOOST_CHECK_EQUAL(result, true);
+		}
+		std::vector<std::pair<std::string, std::string>> report = several.get_smileys([](size_t n){return std::to_string(n);});
+		BOOST_REQUIRE(!report.empty());
+		BOOST_CHECK_EQUAL(report[1].second.rfind("./test/test_files/", 0), 0);
+	}
+	using engine_type = libs::proccesing::io_engine<std::string, size_t>;
+	BOOST_CHECK_THROW(engine_type(std::vector<std::string>{}, 64), libs::exception::custom_exception);
+	BOOST_CHECK_THROW(engine_type(std::vector<std::string>{"-", files.front(), "-"}, 64), libs::exception::custom_exception);
+}
+// Testing a file which positions would reach the index of the next file is rejected before it is read.
+BOOST_AUTO_TEST_CASE(TEST_SEVERAL_INPUTS_TOO_LARGE)
+{
+	const std::filesystem::path path = std::filesystem::temp_directory_path() / "analyze_statistics_too_large.txt";
+	{
+		std::ofstream os(path);
+	}
+	// the file is sparse, so it takes no space on the disk
+	std::error_code ec;
+	std::filesystem::resize_file(path, size_t(1) << libs::utils::input_offset_bits, ec);
+	if(ec) {
+		BOOST_TEST_MESSAGE("The file system doesn't allow a sparse file of 1 TiB: " << ec.message());
+		std::filesystem::remove(path);
+		return;
+	}
+	libs::proccesing::io_engine<std::string, size_t> several(std::vector<std::string>{"./test/test_files/file.txt", path.string()}, 64, "", 2);
+	BOOST_CHECK_THROW(several.read(), libs::exception::custom_exception);
+	BOOST_CHECK_EQUAL(several.get_map().size(), 0);
+	std::filesystem::remove(path);
+}
+
+// TESTS OF THE SNAPSHOTS
+// Testing the snapshots of the shards written by separate processes are merged into the statistics of the whole file.
+BOOST_FIXTURE_TEST_CASE(TEST_SNAPSHOT_MERGE, file_op_fixture)
+{
+	obj.read();
+	const std::filesystem::path dir = std::filesystem::temp_directory_path() / "analyze_statistics_snapshots";
+	std::filesystem::remove_all(dir);
+	std::filesystem::create_directories(dir);
+	std::ifstream is("./test/test_files/file.txt", std::ios::binary);
+	const std::string text((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+	// the shards are split at the spaces, so no word is cut
+	std::vector<size_t> bounds{0};
+	for(size_t i = 1; i < 3; ++i) {
+		bounds.push_back(text.find(' ', text.size() * i / 3));
+	}
+	bounds.push_back(text.size());
+	std::vector<std::string> shards{};
+	std::vector<std::string> snapshots{};
+	for(size_t i = 0; i + 1 < bounds.size(); ++i) {
+		shards.push_back((dir / ("shard" + std::to_string(i) + ".txt")).string());
+		snapshots.push_back((dir / ("shard" + std::to_string(i) + ".snap")).string());
+		std::ofstream os(shards.back(), std::ios::binary);
+		os << text.substr(bounds[i], bounds[i + 1] - bounds[i]);
+	}
+	std::vector<pid_t> children{};
+	for(size_t i = 0; i < shards.size(); ++i) {
+		const pid_t pid = fork();
+		BOOST_REQUIRE(pid >= 0);
+		if(pid == 0) {
+			int status = 0;
+			try {
+				libs::proccesing::io_engine<std::string, size_t> shard(shards[i], 64, "", 2);
+				shard.read();
+				shard.save_snapshot(snapshots[i]);
+			} catch(...) {
+				status = 1;
+			}
+			_exit(status);
+		}
+		children.push_back(pid);
+	}
+	for(const pid_t pid: children) {
+		int status = 0;
+		waitpid(pid, &status, 0);
+		BOOST_CHECK_EQUAL(WIFEXITED(status) && WEXITSTATUS(status) == 0, true);
+	}
+	using merger_type = libs::proccesing::snapshot_merger<size_t>;
+	// the merged snapshot of the merged snapshots is the same
+	const std::string merged_path = (dir / "merged.snap").string();
+	merger_type(snapshots).write(merged_path);
+	for(const std::vector<std::string>& paths: {snapshots, std::vector<std::string>{merged_path}}) {
+		merger_type merger(paths);
+		BOOST_CHECK_EQUAL_COLLECTIONS(merger.inputs().begin(), merger.inputs().end(), shards.begin(), shards.end());
+		std::unordered_map<std::string, size_t> words{};
+		merger_type(paths).for_each_word([&words](std::string_view word, size_t freq) {
+				words.emplace(word, freq);
+				});
+		bool result = (obj.get_map() == words);
+		BOOST_CHECK_EQUAL(result, true);
+		const auto top = merger.top_n(5);
+		const auto expected_top = obj.query_n_most_frequent(5, [](size_t n){return std::to_string(n);});
+		BOOST_REQUIRE_EQUAL(top.size() * 2, expected_top.size());
+		for(size_t i = 0; i < top.size(); ++i) {
+			BOOST_CHECK_EQUAL(top[i].first, expected_top[2 * i].second);
+			BOOST_CHECK_EQUAL(std::to_string(top[i].second), expected_top[2 * i + 1].second);
+		}
+		// the positions in the shards are mapped back to the positions in the whole file
+		std::unordered_map<std::string, std::vector<size_t>> smileys{};
+		for(const auto& [code, positions]: merger.smileys()) {
+			for(const auto pos: positions) {
+				const auto [input, local] = merger_type::split_position(pos);
+				smileys[code].push_back(bounds[input] + local);
+			}
+		}
+		std::unordered_map<std::string, std::vector<size_t>> expected_smileys = obj.get_smileys_map();
+		for(auto& [code, positions]: expected_smileys) {
+			std::sort(positions.begin(), positions.end());
+			std::sort(smileys[code].begin(), smileys[code].end());
+		}
+		result = (smileys == expected_smileys);
+		BOOST_CHECK_EQUAL(result, true);
+	}
+	{
+		std::ofstream os((dir / "broken.snap").string(), std::ios::binary);
+		os << "not a snapshot at all, just some text which is long enough for the header";
+	}
+	BOOST_CHECK_THROW(merger_type({(dir / "broken.snap").string()}), libs::exception::custom_exception);
+	std::filesystem::remove_all(dir);
+}
+
+// TESTS OF THE PIPELINE PROFILE
+// Testing the histogram buckets are the powers of two.
+BOOST_AUTO_TEST_CASE(TEST_LOG2_HISTOGRAM)
+{
+	libs::analysis::log2_histogram histogram{};
+	for(uint64_t value: std::vector<uint64_t>{0, 1, 2, 3, 4, 1000, UINT64_MAX}) {
+		histogram.record(value);
+	}
+	BOOST_CHECK_EQUAL(histogram.count(0), 1);
+	BOOST_CHECK_EQUAL(histogram.count(1), 1);
+	BOOST_CHECK_EQUAL(histogram.count(2), 2);
+	BOOST_CHECK_EQUAL(histogram.count(3), 1);
+	BOOST_CHECK_EQUAL(histogram.count(10), 1);
+	BOOST_CHECK_EQUAL(histogram.count(64), 1);
+	BOOST_CHECK_EQUAL(libs::analysis::log2_histogram::upper_bound(10), 1024);
+}
+
+// Testing the profile accounts for every byte, word and chunk of the input and describes the run.
+BOOST_FIXTURE_TEST_CASE(TEST_PIPELINE_PROFILE, file_op_fixture)
+{
+	BOOST_CHECK(obj.get_profile() == nullptr);
+	obj.set_profiling(true);
+	obj.read();
+	obj.query_n_most_frequent(5, [](size_t n){return std::to_string(n);});
+	libs::analysis::pipeline_profile* profile = obj.get_profile();
+	BOOST_REQUIRE(profile != nullptr);
+	BOOST_CHECK_EQUAL(profile->bytes(), std::filesystem::file_size("./test/test_files/file.txt"));
+	size_t tokens = 0;
+	for(const auto& [word, freq]: obj.get_map()) {
+		tokens += freq;
+	}
+	BOOST_CHECK_EQUAL(profile->tokens(), tokens);
+	BOOST_CHECK(profile->chunks() > 1);
+	BOOST_CHECK_EQUAL(profile->stage_calls(libs::analysis::pipeline_stage::smileys), profile->chunks());
+	BOOST_CHECK_EQUAL(profile->stage_calls(libs::analysis::pipeline_stage::tokenize), profile->chunks());
+	BOOST_CHECK_EQUAL(profile->stage_calls(libs::analysis::pipeline_stage::submit_wait), profile->chunks());
+	BOOST_CHECK_EQUAL(profile->stage_calls(libs::analysis::pipeline_stage::read), 1);
+	BOOST_CHECK_EQUAL(profile->stage_calls(libs::analysis::pipeline_stage::query), 1);
+	BOOST_CHECK_EQUAL(profile->stage_calls(libs::analysis::pipeline_stage::db_write), 0);
+	uint64_t depths = 0;
+	for(size_t bucket = 0; bucket < libs::analysis::log2_histogram::buckets_count; ++bucket) {
+		depths += profile->queue_depth().count(bucket);
+	}
+	BOOST_CHECK_EQUAL(depths, profile->chunks());
+	const std::string json = profile->to_json();
+	BOOST_CHECK(json.find("\"reader\": \"ifstream\"") != std::string::npos);
+	BOOST_CHECK(json.find("\"tokens\": " + std::to_string(tokens)) != std::string::npos);
+	BOOST_CHECK(json.find("\"peak_rss_bytes\": 0,") == std::string::npos);
+	// the database writes and the lock waits are recorded as well
+	obj_db.set_profiling(true);
+	obj_db.set_db_batch_size(1);
+	obj_db.read();
+	BOOST_CHECK(obj_db.get_profile()->stage_calls(libs::analysis::pipeline_stage::db_write) > 0);
+	uint64_t waits = 0;
+	for(size_t bucket = 0; bucket < libs::analysis::log2_histogram::buckets_count; ++bucket) {
+		waits += obj_db.get_profile()->lock_wait().count(bucket);
+	}
+	BOOST_CHECK(waits >= obj_db.get_profile()->stage_calls(libs::analysis::pipeline_stage::db_write));
+	obj_db.set_profiling(false);
+	BOOST_CHECK(obj_db.get_profile() == nullptr);
+}
+
+// TESTS OF THE MEMORY LIMIT
+// Testing the counting stays in the ram-memory below the limit and falls back to the spilling above it, with the same results.
+BOOST_AUTO_TEST_CASE(TEST_MEMORY_LIMIT)
+{
+	const std::filesystem::path dir = std::filesystem::temp_directory_path() / "analyze_statistics_memory_limit";
+	std::filesystem::remove_all(dir);
+	std::filesystem::create_directories(dir);
+	// the tables are kept under half of the limit, i.e. 512 KiB
+	const size_t limit = size_t(1) << 20;
+	// 100 distinct words take a 64 KiB arena block and a few KiB of slots in every worker's table
+	const std::string small_path = (dir / "small.txt").string();
+	{
+		std::ofstream os(small_path, std::ios::binary);
+		for(size_t i = 0; i < 20000; ++i) {
+			os << "word" << i % 100 << (i % 100 == 0 ? " :-) " : " ");
+		}
+	}
+	// 50000 distinct words take at least 50000 slots of 32 bytes, whatever workers count them
+	const std::string large_path = (dir / "large.txt").string();
+	{
+		std::ofstream os(large_path, std::ios::binary);
+		for(size_t i = 0; i < 100000; ++i) {
+			os << "word" << (i * 7919) % 50000 << (i % 100 == 0 ? " :-) " : " ");
+		}
+	}
+	for(const std::string& path: {small_path, large_path}) {
+		const bool above = (path == large_path);
+		libs::proccesing::io_engine<std::string, size_t> expected(path, 4096, "", 2);
+		expected.read();
+		libs::proccesing::io_engine<std::string, size_t> limited(path, 4096, "", 2);
+		limited.set_memory_limit(limit, (dir / "runs").string());
+		limited.read();
+		BOOST_CHECK_EQUAL(limited.is_out_of_core(), above);
+		BOOST_CHECK_EQUAL(limited.get_spilled_runs_count() > 0, above);
+		BOOST_CHECK_EQUAL(limited.get_peak_footprint() > limit / 2, above);
+		bool result = (limited.get_map() == expected.get_map());
+		BOOST_CHECK_EQUAL(result, true);
+		std::unordered_map<std::string, std::vector<size_t>> expected_smileys = expected.get_smileys_map();
+		std::unordered_map<std::string, std::vector<size_t>> smileys = limited.get_smileys_map();
+		for(auto& [code, positions]: expected_smileys) {
+			std::sort(positions.begin(), positions.end());
+			std::sort(smileys[code].begin(), smileys[code].end());
+		}
+		result = (smileys == expected_smileys);
+		BOOST_CHECK_EQUAL(result, true);
+		const auto top = limited.query_n_most_frequent(3, [](size_t n){return std::to_string(n);});
+		const auto expected_top = expected.query_n_most_frequent(3, [](size_t n){return std::to_string(n);});
+		result = (top == expected_top);
+		BOOST_CHECK_EQUAL(result, true);
+	}
+	std::filesystem::remove_all(dir);
+}
+
+// Testing the positions of the smileys are spilled once they alone exceed the limit, with the same results.
+BOOST_AUTO_TEST_CASE(TEST_MEMORY_LIMIT_SMILEYS)
+{
+	const std::filesystem::path dir = std::filesystem::temp_directory_path() / "analyze_statistics_memory_limit_smileys";
+	std::filesystem::remove_all(dir);
+	std::filesystem::create_directories(dir);
+	// the tables and the smileys are kept under half of the limit, i.e. 256 KiB
+	const size_t limit = size_t(1) << 19;
+	// a single word takes a 64 KiB arena block in every worker's table, every smiley takes at least a byte
+	const std::string path = (dir / "smileys.txt").string();
+	{
+		std::ofstream os(path, std::ios::binary);
+		os << "word ";
+		for(size_t i = 0; i < 2000000; ++i) {
+			os << ":-) ";
+		}
+	}
+	libs::proccesing::io_engine<std::string, size_t> expected(path, 4096, "", 2);
+	expected.read();
+	libs::proccesing::io_engine<std::string, size_t> limited(path, 4096, "", 2);
+	limited.set_memory_limit(limit, (dir / "runs").string());
+	limited.read();
+	BOOST_CHECK_EQUAL(limited.is_out_of_core(), true);
+	BOOST_CHECK(limited.get_spilled_runs_count() > 0);
+	// the 2 MB of the positions never stay in the ram-memory at once
+	BOOST_CHECK(limited.get_peak_footprint() > limit / 2);
+	BOOST_CHECK(limited.get_peak_footprint() < 2 * limit);
+	bool result = (limited.get_map() == expected.get_map());
+	BOOST_CHECK_EQUAL(result, true);
+	std::unordered_map<std::string, std::vector<size_t>> expected_smileys = expected.get_smileys_map();
+	std::unordered_map<std::string, std::vector<size_t>> smileys = limited.get_smileys_map();
+	for(auto& [code, positions]: expected_smileys) {
+		std::sort(positions.begin(), positions.end());
+		std::sort(smileys[code].begin(), smileys[code].end());
+	}
+	result = (smileys == expected_smileys);
+	BOOST_CHECK_EQUAL(result, true);
+	std::filesystem::remove_all(dir);
+}
+// TESTS OF THE POSITION LIST
+
+// Testing the encoded positions decode to the added ones, in any order and of any width
+BOOST_AUTO_TEST_CASE(TEST_POSITION_LIST)
+{
+	const std::vector<uint64_t> positions{5, 7, 7, 1000000, 3, 0, UINT64_MAX, 1, UINT64_MAX - 1};
+	libs::datastructure::position_list<uint64_t> list(positions);
+	BOOST_CHECK_EQUAL(list.size(), positions.size());
+	bool result = (list.to_vector() == positions);
+	BOOST_CHECK_EQUAL(result, true);
+	result = (libs::datastructure::position_list<uint64_t>::from_bytes(list.bytes()) == list);
+	BOOST_CHECK_EQUAL(result, true);
+	result = (libs::datastructure::position_list<uint64_t>::from_bytes(list.bytes()).to_vector() == positions);
+	BOOST_CHECK_EQUAL(result, true);
+	std::vector<uint64_t> sorted = positions;
+	std::sort(sorted.begin(), sorted.end());
+	list.sort();
+	result = (list.to_vector() == sorted);
+	BOOST_CHECK_EQUAL(result, true);
+	libs::datastructure::position_list<int> negative(std::vector<int>{-5, 3, -2147483647 - 1, 2147483647});
+	result = (negative.to_vector() == std::vector<int>{-5, 3, -2147483647 - 1, 2147483647});
+	BOOST_CHECK_EQUAL(result, true);
+	// a position split in the middle of its bytes
+	std::string truncated(list.bytes());
+	truncated.back() = static_cast<char>(0x80);
+	BOOST_CHECK_THROW(libs::datastructure::position_list<uint64_t>::from_bytes(truncated), libs::exception::custom_exception);
+}
+// Testing the appended lists of the chunks equal the list of all the positions and take a byte per close position
+BOOST_AUTO_TEST_CASE(TEST_POSITION_LIST_APPEND)
+{
+	std::vector<size_t> all{};
+	std::vector<libs::datastructure::position_list<size_t>> chunks(4);
+	// the chunks are appended out of the text order, like the workers finish them
+	const size_t order[] = {2, 0, 3, 1};
+	for(size_t chunk: order) {
+		for(size_t pos = chunk * 100000 + 17; pos < (chunk + 1) * 100000; pos += 37) {
+			chunks[chunk].push_back(pos);
+			all.push_back(pos);
+		}
+	}
+	libs::datastructure::position_list<size_t> list{};
+	list.append(libs::datastructure::position_list<size_t>());
+	for(size_t chunk: order) {
+		list.append(chunks[chunk]);
+	}
+	bool result = (list.to_vector() == all);
+	BOOST_CHECK_EQUAL(result, true);
+	BOOST_CHECK(list.bytes().size() < 2 * all.size());
+	std::sort(all.begin(), all.end());
+	list.sort();
+	result = (list.to_vector() == all);
+	BOOST_CHECK_EQUAL(result, true);
+	BOOST_CHECK_EQUAL(list.bytes().size(), all.size());
+}
+
+// TESTS OF THE CHECKPOINTS
+// Testing the runs over an append-only file count only the appended lines and end with the statistics of the whole file.
+BOOST_AUTO_TEST_CASE(TEST_CHECKPOINT_RESUME)
+{
+	const std::filesystem::path dir = std::filesystem::temp_directory_path() / "analyze_statistics_checkpoint";
+	std::filesystem::remove_all(dir);
+	std::filesystem::create_directories(dir);
+	const std::string path = (dir / "app.log").string();
+	const std::string db_path = (dir / "stats.db").string();
+	auto to_string = [](size_t n){return std::to_string(n);};
+	// the counts and the positions of every smiley kept in the database
+	auto db_stats = [&to_string](libs::proccesing::io_engine<std::string, size_t>& engine) {
+		std::map<std::string, std::string> ret{};
+		const auto words = engine.query_n_most_frequent(1000000, to_string);
+		for(size_t i = 0; i < words.size(); i += 2) {
+			ret[words[i].second] = words[i + 1].second;
+		}
+		const auto smileys = engine.get_smileys(to_string);
+		for(size_t i = 0; i < smileys.size(); i += 2) {
+			ret["smiley " + smileys[i].second] = smileys[i + 1].second;
+		}
+		return ret;
+	};
+	auto golden_stats = [&dir, &db_stats](const std::string& path) {
+		const std::string golden_db = (dir / "golden.db").string();
+		std::filesystem::remove(golden_db);
+		libs::proccesing::io_engine<std::string, size_t> golden(path, 64, golden_db, 2);
+		golden.read();
+		return db_stats(golden);
+	};
+	auto append = [&path](size_t first_line, size_t last_line, const std::string& tail) {
+		std::ofstream os(path, std::ios::binary | std::ios::app);
+		for(size_t i = first_line; i < last_line; ++i) {
+			os << "line" << i % 7 << " word" << (i * 31) % 50 << (i % 5 == 0 ? " :-) " : " ") << "end\n";
+		}
+		os << tail;
+	};
+	append(0, 300, "unterminated wo");
+	const size_t first_size = std::filesystem::file_size(path);
+	{
+		libs::proccesing::io_engine<std::string, size_t> first(path, 64, db_path, 2);
+		first.set_resumable(true);
+		first.read();
+		BOOST_CHECK_EQUAL(first.get_resumed_from(), 0);
+		// the line being appended is left for the next run
+		BOOST_CHECK_EQUAL(first.get_checkpoint(), first_size - std::string("unterminated wo").size());
+		BOOST_CHECK_EQUAL(first.get_map().count("unterminated"), 0);
+	}
+	// the unterminated line is completed first
+	append(0, 0, "rd :]\n");
+	append(300, 700, "");
+	const std::map<std::string, std::string> expected = golden_stats(path);
+	{
+		libs::proccesing::io_engine<std::string, size_t> second(path, 64, db_path, 2);
+		second.set_resumable(true);
+		second.read();
+		BOOST_CHECK_EQUAL(second.get_resumed_from(), first_size - std::string("unterminated wo").size());
+		BOOST_CHECK_EQUAL(second.get_checkpoint(), std::filesystem::file_size(path));
+		// only the tail starting with the completed line is counted by this run, the database holds the totals
+		BOOST_CHECK_EQUAL(second.get_map()["unterminated"], 1);
+		BOOST_CHECK_EQUAL(second.get_map()["word"], 1);
+		BOOST_CHECK(second.get_map()["end"] < 700);
+		bool result = (db_stats(second) == expected);
+		BOOST_CHECK_EQUAL(result, true);
+		// nothing has been appended since
+		second.read();
+		BOOST_CHECK_EQUAL(second.get_checkpoint(), std::filesystem::file_size(path));
+		result = (db_stats(second) == expected);
+		BOOST_CHECK_EQUAL(result, true);
+	}
+	// the rotated log is a new file which is read from its beginning
+	std::filesystem::remove(path);
+	append(1000, 1100, "");
+	{
+		libs::proccesing::io_engine<std::string, size_t> rotated(path, 64, db_path, 2);
+		rotated.set_resumable(true);
+		rotated.read();
+		BOOST_CHECK_EQUAL(rotated.get_resumed_from(), 0);
+		bool result = (db_stats(rotated) == golden_stats(path));
+		BOOST_CHECK_EQUAL(result, true);
+	}
+	libs::proccesing::io_engine<std::string, size_t> memory(path, 64);
+	BOOST_CHECK_THROW(memory.set_resumable(true), libs::exception::custom_exception);
+	std::filesystem::remove_all(dir);
+}
+// Testing a run killed in the middle is resumed from its last committed batch without counting any chunk twice.
+BOOST_AUTO_TEST_CASE(TEST_CHECKPOINT_CRASH)
+{
+	const std::filesystem::path dir = std::filesystem::temp_directory_path() / "analyze_statistics_checkpoint_crash";
+	std::filesystem::remove_all(dir);
+	std::filesystem::create_directories(dir);
+	const std::string path = (dir / "app.log").string();
+	const std::string db_path = (dir / "stats.db").string();
+	{
+		std::ofstream os(path, std::ios::binary);
+		for(size_t i = 0; i < 200000; ++i) {
+			os << "request" << (i * 7919) % 3000 << " status" << i % 5 << (i % 97 == 0 ? " :) " : " ") << "done\n";
+		}
+	}
+	// the child signals once its first batch has moved the checkpoint and waits for the kill inside the second one
+	static int signal_fd = -1;
+	int fds[2];
+	BOOST_REQUIRE_EQUAL(pipe(fds), 0);
+	const pid_t pid = fork();
+	BOOST_REQUIRE(pid >= 0);
+	if(pid == 0) {
+		close(fds[0]);
+		signal_fd = fds[1];
+		sqlite3_auto_extension(reinterpret_cast<void(*)(void)>(+[](sqlite3* db, const char**, const sqlite3_api_routines*) {
+				sqlite3_update_hook(db, [](void*, int op, const char*, const char* table, sqlite3_int64) {
+						static size_t updates = 0;
+						if(op == SQLITE_UPDATE && std::string_view(table) == "CHECKPOINT" && ++updates == 2) {
+							const char byte = 1;
+							if(write(signal_fd, &byte, 1) == 1) {
+								for(;;) {
+									pause();
+								}
+							}
+						}
+						}, nullptr);
+				return SQLITE_OK;
+				}));
+		try {
+			libs::proccesing::io_engine<std::string, size_t> crashed(path, 4096, db_path, 2);
+			crashed.set_resumable(true);
+			crashed.set_db_batch_size(1);
+			crashed.read();
+		} catch(...) {
+		}
+		_exit(0);
+	}
+	close(fds[1]);
+	char byte = 0;
+	const ssize_t signalled = read(fds[0], &byte, 1);
+	close(fds[0]);
+	kill(pid, SIGKILL);
+	int status = 0;
+	waitpid(pid, &status, 0);
+	BOOST_REQUIRE_EQUAL(signalled, 1);
+	libs::proccesing::io_engine<std::string, size_t> memory(path, 4096, "", 2);
+	memory.read();
+	libs::proccesing::io_engine<std::string, size_t> resumed(path, 4096, db_path, 2);
+	resumed.set_resumable(true);
+	resumed.read();
+	BOOST_TEST_MESSAGE("The killed run has committed " << resumed.get_resumed_from() << " bytes");
+	BOOST_CHECK(resumed.get_resumed_from() > 0 && resumed.get_resumed_from() < std::filesystem::file_size(path));
+	BOOST_CHECK_EQUAL(resumed.get_checkpoint(), std::filesystem::file_size(path));
+	const auto words = resumed.query_n_most_frequent(1000000, [](size_t n){return std::to_string(n);});
+	std::unordered_map<std::string, size_t> freq{};
+	for(size_t i = 0; i < words.size(); i += 2) {
+		freq[words[i].second] = std::stoul(words[i + 1].second);
+	}
+	bool result = (freq == memory.get_map());
+	BOOST_CHECK_EQUAL(result, true);
+	const auto rows = resumed.get_smileys([](size_t n){return std::to_string(n);});
+	BOOST_REQUIRE_EQUAL(rows.size(), 2);
+	std::vector<size_t> positions{};
+	std::istringstream is(rows[1].second);
+	for(size_t pos = 0; is >> pos;) {
+		positions.push_back(pos);
+	}
+	std::vector<size_t> expected_positions = memory.get_smileys_map()[":)"];
+	std::sort(expected_positions.begin(), expected_positions.end());
+	result = (positions == expected_positions);
+	BOOST_CHECK_EQUAL(result, true);
+	std::filesystem::remove_all(dir);
+}
+
+// TESTS OF THE FOLLOW MODE
+// Testing the lines appended to a followed file are counted while it is followed and a rotated file is followed from its beginning.
+BOOST_AUTO_TEST_CASE(TEST_FOLLOW)
+{
+	const std::filesystem::path dir = std::filesystem::temp_directory_path() / "analyze_statistics_follow";
+	std::filesystem::remove_all(dir);
+	std::filesystem::create_directories(dir);
+	const std::string path = (dir / "app.log").string();
+	auto append = [&path](size_t first_line, size_t last_line, const std::string& word) {
+		std::ofstream os(path, std::ios::binary | std::ios::app);
+		for(size_t i = first_line; i < last_line; ++i) {
+			os << word << i % 7 << " item" << (i * 13) % 40 << (i % 6 == 0 ? " :] " : " ") << "end\n";
+		}
+	};
+	append(0, 100, "line");
+	std::atomic<bool> written{false};
+	std::atomic<int64_t> written_at{0};
+	std::thread writer([&append, &path, &written, &written_at]() {
+			for(size_t batch = 1; batch < 5; ++batch) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(150));
+				append(batch * 100, batch * 100 + 100, "line");
+			}
+			written_at = std::chrono::steady_clock::now().time_since_epoch().count();
+			written = true;
+			});
+	libs::proccesing::io_engine<std::string, size_t> follower(path, 64, "", 2);
+	follower.track_top_n(3);
+	const auto start = std::chrono::steady_clock::now();
+	int64_t counted_at = 0;
+	follower.follow([&]() {
+			if(written && follower.get_checkpoint() == std::filesystem::file_size(path)) {
+				counted_at = std::chrono::steady_clock::now().time_since_epoch().count();
+				return false;
+			}
+			return std::chrono::steady_clock::now() - start < std::chrono::seconds(10);
+			});
+	writer.join();
+	BOOST_REQUIRE(counted_at != 0);
+	// the latency depends on the load of the machine, so it is only reported
+	BOOST_TEST_MESSAGE("The appended lines have been counted in " << std::chrono::duration_cast<std::chrono::milliseconds>(
+				std::chrono::steady_clock::duration(counted_at - written_at)).count() << " ms");
+	libs::proccesing::io_engine<std::string, size_t> expected(path, 64, "", 2);
+	expected.read();
+	bool result = (follower.get_map() == expected.get_map());
+	BOOST_CHECK_EQUAL(result, true);
+	result = (follower.get_smileys_map() == expected.get_smileys_map());
+	BOOST_CHECK_EQUAL(result, true);
+	auto to_string = [](size_t n){return std::to_string(n);};
+	result = (follower.query_n_most_frequent(3, to_string) == expected.query_n_most_frequent(3, to_string));
+	BOOST_CHECK_EQUAL(result, true);
+	// the log is rotated while it is followed
+	std::thread rotator([&append, &path]() {
+			std::this_thread::sleep_for(std::chrono::milliseconds(150));
+			std::filesystem::remove(path);
+			append(0, 50, "rotated");
+			});
+	const auto rotation_start = std::chrono::steady_clock::now();
+	follower.follow([&]() {
+			std::error_code ec;
+			if(follower.get_map().count("rotated0") != 0 && follower.get_checkpoint() == std::filesystem::file_size(path, ec)) {
+				return false;
+			}
+			return std::chrono::steady_clock::now() - rotation_start < std::chrono::seconds(10);
+			});
+	rotator.join();
+	libs::proccesing::io_engine<std::string, size_t> rotated(path, 64, "", 2);
+	rotated.read();
+	result = (follower.get_map() == rotated.get_map());
+	BOOST_CHECK_EQUAL(result, true);
+	result = (follower.query_n_most_frequent(3, to_string) == rotated.query_n_most_frequent(3, to_string));
+	BOOST_CHECK_EQUAL(result, true);
+	// the log is truncated and written again in place between two checks, longer than it was
+	size_t checks = 0;
+	follower.follow([&]() {
+			if(checks++ == 0) {
+				std::ofstream os(path, std::ios::binary | std::ios::trunc);
+				for(size_t i = 0; i < 200; ++i) {
+					os << "rewritten" << i % 7 << " end\n";
+				}
+				return true;
+			}
+			return false;
+			}, std::chrono::milliseconds(10));
+	libs::proccesing::io_engine<std::string, size_t> rewritten(path, 64, "", 2);
+	rewritten.read();
+	result = (follower.get_map() == rewritten.get_map());
+	BOOST_CHECK_EQUAL(result, true);
+	std::filesystem::remove_all(dir);
+}